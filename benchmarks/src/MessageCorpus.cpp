@@ -0,0 +1,192 @@
+#include "MessageCorpus.hpp"
+
+#include "messages/Emote.hpp"
+#include "messages/Image.hpp"
+#include "messages/Message.hpp"
+#include "messages/MessageBuilder.hpp"
+#include "messages/MessageElement.hpp"
+
+#include <QPainter>
+#include <QPixmap>
+
+namespace chatterino {
+namespace {
+
+    ImagePtr makeImage(int size, const QColor &color, qreal scale)
+    {
+        QPixmap pixmap(size, size);
+        pixmap.fill(Qt::transparent);
+
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setBrush(color);
+        painter.setPen(color.darker());
+        painter.drawEllipse(pixmap.rect().adjusted(1, 1, -1, -1));
+
+        return Image::fromPixmap(pixmap, scale);
+    }
+
+    EmotePtr makeEmote(const QString &name, const QColor &color, int size)
+    {
+        return std::make_shared<const Emote>(
+            Emote{EmoteName{name},
+                  ImageSet{makeImage(size, color, 1),
+                           makeImage(size * 2, color, 0.5),
+                           makeImage(size * 4, color, 0.25)},
+                  Tooltip{name}, Url{}});
+    }
+
+    struct Assets {
+        std::vector<EmotePtr> emotes;
+        std::vector<EmotePtr> badges;
+    };
+
+    Assets makeAssets()
+    {
+        Assets assets;
+
+        for (int i = 0; i < 24; i++)
+        {
+            auto color = QColor::fromHsv(i * 15, 200, 220);
+            // a few wide emotes like the ones bttv and ffz have
+            assets.emotes.push_back(makeEmote(QString("Emote%1").arg(i), color,
+                                              i % 5 == 0 ? 56 : 28));
+        }
+
+        for (int i = 0; i < 6; i++)
+        {
+            auto color = QColor::fromHsv(i * 60, 255, 255);
+            assets.badges.push_back(
+                makeEmote(QString("badge%1").arg(i), color, 18));
+        }
+
+        return assets;
+    }
+
+    const QStringList words = {
+        "the",     "quick", "brown",   "fox",     "jumps",  "over",
+        "lazy",    "dog",   "chat",    "is",      "moving", "really",
+        "fast",    "today", "https://chatterino.com",     "pog",
+        "another", "word",  "streamer", "wrapped", "text",  "message",
+    };
+
+    QString makeText(int index, int wordCount)
+    {
+        QStringList text;
+        for (int i = 0; i < wordCount; i++)
+        {
+            text.append(words[(index * 7 + i * 3) % words.size()]);
+        }
+        return text.join(' ');
+    }
+
+    void appendHeader(MessageBuilder &builder, const Assets &assets,
+                      int index)
+    {
+        builder.emplace<TimestampElement>(QTime(12, index % 60, index % 60));
+
+        for (int i = 0; i < 1 + index % 3; i++)
+        {
+            auto &badge = assets.badges[(index + i) % assets.badges.size()];
+            builder.emplace<BadgeElement>(badge,
+                                          MessageElementFlag::BadgeVanity);
+        }
+
+        auto name = QString("user%1:").arg(index % 97);
+        builder.emplace<TextElement>(name, MessageElementFlag::Username,
+                                     QColor::fromHsv(index * 37 % 360, 200, 230),
+                                     FontStyle::ChatMediumBold);
+    }
+
+    void appendEmotes(MessageBuilder &builder, const Assets &assets,
+                      int index, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            auto &emote = assets.emotes[(index + i * 5) % assets.emotes.size()];
+
+            builder.emplace<EmoteElement>(emote, MessageElementFlag::BttvEmote);
+
+            if (i % 4 == 3)
+            {
+                builder.emplace<TextElement>(makeText(index + i, 2),
+                                             MessageElementFlag::Text);
+            }
+        }
+    }
+
+}  // namespace
+
+MessageCorpus MessageCorpus::build(int messageCount)
+{
+    static const auto assets = makeAssets();
+
+    static const QString rtl =
+        QString::fromUtf8("مرحبا بالجميع في الدردشة "
+                          "שלום לכולם בצ'אט הזה ");
+    static const QString emoji =
+        QString::fromUtf8("😂 👍 🎉 ❤️ 🔥 😭 🙏 👀 😳 💀 ");
+
+    MessageCorpus corpus;
+
+    for (int i = 0; i < messageCount; i++)
+    {
+        MessageBuilder builder;
+        QString kind;
+
+        appendHeader(builder, assets, i);
+
+        switch (i % 6)
+        {
+            case 0: {
+                kind = "text";
+                builder.emplace<TextElement>(makeText(i, 4 + i % 12),
+                                             MessageElementFlag::Text);
+            }
+            break;
+
+            case 1: {
+                kind = "emotes";
+                appendEmotes(builder, assets, i, 8 + i % 40);
+            }
+            break;
+
+            case 2: {
+                kind = "long";
+                builder.emplace<TextElement>(makeText(i, 80 + i % 40),
+                                             MessageElementFlag::Text);
+            }
+            break;
+
+            case 3: {
+                kind = "rtl";
+                builder.emplace<TextElement>(rtl.repeated(1 + i % 4),
+                                             MessageElementFlag::Text);
+            }
+            break;
+
+            case 4: {
+                kind = "emoji";
+                builder.emplace<TextElement>(emoji.repeated(1 + i % 3),
+                                             MessageElementFlag::Text);
+            }
+            break;
+
+            case 5: {
+                kind = "mixed";
+                builder.emplace<TextElement>(makeText(i, 6),
+                                             MessageElementFlag::Text);
+                appendEmotes(builder, assets, i, 4);
+                builder.emplace<TextElement>(emoji + rtl,
+                                             MessageElementFlag::Text);
+            }
+            break;
+        }
+
+        corpus.entries.push_back({kind, builder.release()});
+    }
+
+    return corpus;
+}
+
+}  // namespace chatterino
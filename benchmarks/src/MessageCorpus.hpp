@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+namespace chatterino {
+
+struct Message;
+using MessagePtr = std::shared_ptr<const Message>;
+
+// A fixed set of messages covering the expensive cases of the layout code:
+// badges, lots of emotes, long wrapped text, right-to-left text and emoji.
+// The same corpus is built on every run so results stay comparable.
+struct MessageCorpus {
+    struct Entry {
+        // what kind of message this is, e.g. "emotes" or "rtl"
+        QString kind;
+        MessagePtr message;
+    };
+
+    static MessageCorpus build(int messageCount);
+
+    std::vector<Entry> entries;
+};
+
+}  // namespace chatterino
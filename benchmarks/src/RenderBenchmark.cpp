@@ -0,0 +1,189 @@
+#include "RenderBenchmark.hpp"
+
+#include "Application.hpp"
+#include "common/Version.hpp"
+#include "debug/Benchmark.hpp"
+#include "messages/Selection.hpp"
+#include "messages/layouts/MessageLayout.hpp"
+#include "singletons/SettingsSnapshot.hpp"
+#include "singletons/WindowManager.hpp"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QPainter>
+#include <QPixmap>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+namespace chatterino {
+namespace {
+
+    // Summarizes the duration of each iteration in milliseconds.
+    QJsonObject summarize(std::vector<qreal> samples, size_t messageCount)
+    {
+        std::sort(samples.begin(), samples.end());
+
+        auto median = samples[samples.size() / 2];
+        auto mean = std::accumulate(samples.begin(), samples.end(), qreal(0)) /
+                    qreal(samples.size());
+
+        return QJsonObject{
+            {"medianMs", median},
+            {"meanMs", mean},
+            {"minMs", samples.front()},
+            {"maxMs", samples.back()},
+            {"medianUsPerMessage", median * 1000 / qreal(messageCount)},
+        };
+    }
+
+}  // namespace
+
+RenderBenchmark::RenderBenchmark(const MessageCorpus &corpus,
+                                 const RenderBenchmarkOptions &options)
+    : corpus_(corpus)
+    , options_(options)
+{
+}
+
+QJsonObject RenderBenchmark::run()
+{
+    QJsonArray cases;
+
+    for (auto scale : this->options_.scales)
+    {
+        for (auto width : this->options_.widths)
+        {
+            cases.append(this->runCase(width, scale));
+        }
+    }
+
+    return QJsonObject{
+        {"version", Version::instance().fullVersion()},
+        {"commit", Version::instance().commitHash()},
+        {"messages", int(this->corpus_.entries.size())},
+        {"iterations", this->options_.iterations},
+        {"cases", cases},
+    };
+}
+
+QJsonObject RenderBenchmark::runCase(int width, float scale)
+{
+    auto *windows = getApp()->windows;
+    auto flags = windows->getWordFlags();
+    auto messageCount = this->corpus_.entries.size();
+
+    std::vector<MessageLayoutPtr> layouts;
+    for (auto &entry : this->corpus_.entries)
+    {
+        layouts.push_back(std::make_shared<MessageLayout>(entry.message));
+    }
+
+    QPixmap surface(width, this->options_.viewportHeight);
+    QPainter painter(&surface);
+    Selection selection;
+
+    // messages get their buffer on the first paint instead of after a few
+    // frames, so the warm up creates all buffers
+    auto settings = *SettingsSnapshot::current();
+    settings.lazyMessageBuffers = false;
+
+    // every pass is one frame of a view
+    uint64_t frame = 0;
+
+    auto paintAll = [&] {
+        frame++;
+        int y = 0;
+        for (size_t i = 0; i < layouts.size(); i++)
+        {
+            if (y > this->options_.viewportHeight)
+            {
+                y = 0;
+            }
+
+            layouts[i]->paint(painter, width, y, int(i), selection, false,
+                              true, false, settings, frame);
+            y += layouts[i]->getHeight();
+        }
+    };
+
+    // warm up: fills the font metric caches and creates the message buffers
+    for (auto &layout : layouts)
+    {
+        layout->layout(width, scale, flags);
+    }
+    paintAll();
+
+    std::vector<qreal> layoutSamples;
+    std::vector<qreal> paintSamples;
+    std::vector<qreal> bufferedSamples;
+    std::map<QString, qint64> nsecsByKind;
+    std::map<QString, int> countByKind;
+
+    for (int i = 0; i < this->options_.iterations; i++)
+    {
+        // lay out everything again, this also bypasses the shared layout
+        // cache
+        windows->incGeneration();
+
+        {
+            BenchmarkGuard guard("layout");
+            QElapsedTimer timer;
+
+            for (size_t j = 0; j < layouts.size(); j++)
+            {
+                timer.start();
+                layouts[j]->layout(width, scale, flags);
+
+                auto &kind = this->corpus_.entries[j].kind;
+                nsecsByKind[kind] += timer.nsecsElapsed();
+                countByKind[kind]++;
+            }
+
+            layoutSamples.push_back(guard.getElapsedMs());
+        }
+
+        for (auto &layout : layouts)
+        {
+            layout->invalidateBuffer();
+        }
+
+        {
+            BenchmarkGuard guard("paint");
+            paintAll();
+            paintSamples.push_back(guard.getElapsedMs());
+        }
+
+        {
+            BenchmarkGuard guard("paint buffered");
+            paintAll();
+            bufferedSamples.push_back(guard.getElapsedMs());
+        }
+    }
+
+    QJsonObject layoutByKind;
+    for (auto &&[kind, nsecs] : nsecsByKind)
+    {
+        layoutByKind[kind] = qreal(nsecs) / 1000 / qreal(countByKind[kind]);
+    }
+
+    int totalHeight = 0;
+    for (auto &layout : layouts)
+    {
+        totalHeight += layout->getHeight();
+    }
+
+    return QJsonObject{
+        {"width", width},
+        {"scale", scale},
+        {"totalHeight", totalHeight},
+        {"lazyMessageBuffers", settings.lazyMessageBuffers},
+        {"layout", summarize(layoutSamples, messageCount)},
+        {"layoutMeanUsPerMessageByKind", layoutByKind},
+        {"paint", summarize(paintSamples, messageCount)},
+        {"paintBuffered", summarize(bufferedSamples, messageCount)},
+    };
+}
+
+}  // namespace chatterino
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "MessageCorpus.hpp"
+
+#include <QJsonObject>
+
+#include <vector>
+
+namespace chatterino {
+
+struct RenderBenchmarkOptions {
+    std::vector<int> widths;
+    std::vector<float> scales;
+    int iterations = 20;
+    // height of the surface the messages are painted on
+    int viewportHeight = 1080;
+};
+
+// Lays out and paints every message of a corpus at each combination of width
+// and scale, like a ChannelView would.
+//
+// Three things are measured for every combination:
+//  - layout: MessageLayout::layout after the layout generation was bumped, so
+//    every message is laid out again. Word widths stay cached in the message
+//    elements, just like in the app.
+//  - paint: MessageLayout::paint with invalidated buffers, which redraws all
+//    elements into the message buffers. Lazy message buffers are turned off,
+//    so this doesn't cover drawing messages directly before they got a
+//    buffer.
+//  - paintBuffered: MessageLayout::paint with valid buffers, which is what
+//    scrolling costs
+class RenderBenchmark
+{
+public:
+    RenderBenchmark(const MessageCorpus &corpus,
+                    const RenderBenchmarkOptions &options);
+
+    // Returns the results of all combinations as json.
+    QJsonObject run();
+
+private:
+    QJsonObject runCase(int width, float scale);
+
+    const MessageCorpus &corpus_;
+    RenderBenchmarkOptions options_;
+};
+
+}  // namespace chatterino
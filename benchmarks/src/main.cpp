@@ -0,0 +1,134 @@
+#include "Application.hpp"
+#include "MessageCorpus.hpp"
+#include "RenderBenchmark.hpp"
+#include "singletons/Paths.hpp"
+#include "singletons/Settings.hpp"
+#include "singletons/WindowManager.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+
+#include <iostream>
+
+using namespace chatterino;
+
+namespace {
+
+template <typename T, typename Parse>
+std::vector<T> parseList(const QString &value, Parse parse)
+{
+    std::vector<T> list;
+    for (auto &part : value.split(',', QString::SkipEmptyParts))
+    {
+        bool ok = false;
+        auto number = parse(part.trimmed(), &ok);
+        if (ok && number > 0)
+        {
+            list.push_back(T(number));
+        }
+    }
+    return list;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    // no display is needed and the results don't depend on the window system
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication::setAttribute(Qt::AA_Use96Dpi, true);
+    QApplication::setAttribute(Qt::AA_DisableHighDpiScaling, true);
+
+    QApplication a(argc, argv);
+
+    // keeps the benchmark out of the regular chatterino directories
+    QCoreApplication::setApplicationName("chatterino-render-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures message layout and paint throughput. Results are written as "
+        "json.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"widths", "Comma separated view widths.", "widths", "300,600,1200"},
+        {"scales", "Comma separated scales.", "scales", "1,1.5,2"},
+        {"messages", "Number of messages in the corpus.", "count", "600"},
+        {"iterations", "Measured iterations per case.", "count", "20"},
+        {"output", "Write the results to this file instead of stdout.",
+         "file"},
+    });
+    parser.process(a);
+
+    RenderBenchmarkOptions options;
+    options.widths = parseList<int>(parser.value("widths"),
+                                    [](const QString &s, bool *ok) {
+                                        return s.toInt(ok);
+                                    });
+    options.scales = parseList<float>(parser.value("scales"),
+                                      [](const QString &s, bool *ok) {
+                                          return s.toFloat(ok);
+                                      });
+    options.iterations = std::max(1, parser.value("iterations").toInt());
+    auto messageCount = std::max(1, parser.value("messages").toInt());
+
+    if (options.widths.empty() || options.scales.empty())
+    {
+        std::cerr << "No valid widths or scales given" << std::endl;
+        return 1;
+    }
+
+    // default settings, so the results don't depend on the user's config
+    QTemporaryDir settingsDirectory;
+    if (!settingsDirectory.isValid())
+    {
+        std::cerr << "Unable to create a settings directory" << std::endl;
+        return 1;
+    }
+
+    Paths *paths{};
+    try
+    {
+        paths = new Paths;
+    }
+    catch (std::runtime_error &error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    Settings settings(settingsDirectory.path());
+
+    // the singletons are created but not initialized, nothing connects to
+    // twitch or loads emotes
+    Application app(settings, *paths);
+    app.windows->updateWordTypeMask();
+
+    auto corpus = MessageCorpus::build(messageCount);
+    auto results = RenderBenchmark(corpus, options).run();
+    auto json = QJsonDocument(results).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            std::cerr << "Unable to open " << file.fileName().toStdString()
+                      << std::endl;
+            return 1;
+        }
+        file.write(json);
+    }
+    else
+    {
+        std::cout << json.toStdString();
+    }
+
+    return 0;
+}
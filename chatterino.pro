@@ -131,6 +131,7 @@ SOURCES += \
     src/common/ChatterSet.cpp \
     src/common/CompletionModel.cpp \
     src/common/Credentials.cpp \
+    src/common/DiskCache.cpp \
     src/common/DownloadManager.cpp \
     src/common/Env.cpp \
     src/common/LinkParser.cpp \
@@ -168,11 +169,19 @@ SOURCES += \
     src/controllers/taggedusers/TaggedUser.cpp \
     src/controllers/taggedusers/TaggedUsersModel.cpp \
     src/debug/Benchmark.cpp \
+    src/debug/FrameStats.cpp \
     src/main.cpp \
     src/messages/Emote.cpp \
+    src/messages/EmoteSnapshot.cpp \
     src/messages/Image.cpp \
+    src/messages/ImageLoader.cpp \
+    src/messages/ImageMemoryManager.cpp \
+    src/messages/ImageRegistry.cpp \
+    src/messages/ImageUploader.cpp \
     src/messages/ImageSet.cpp \
+    src/messages/layouts/ImageAtlas.cpp \
     src/messages/layouts/MessageLayout.cpp \
+    src/messages/layouts/MessageLayoutCache.cpp \
     src/messages/layouts/MessageLayoutContainer.cpp \
     src/messages/layouts/MessageLayoutElement.cpp \
     src/messages/Link.cpp \
@@ -206,6 +215,7 @@ SOURCES += \
     src/providers/LinkResolver.cpp \
     src/providers/twitch/api/Helix.cpp \
     src/providers/twitch/api/Kraken.cpp \
+    src/providers/twitch/ChannelImagePrefetcher.cpp \
     src/providers/twitch/ChannelPointReward.cpp \
     src/providers/twitch/IrcMessageHandler.cpp \
     src/providers/twitch/PubsubActions.cpp \
@@ -232,6 +242,7 @@ SOURCES += \
     src/singletons/Paths.cpp \
     src/singletons/Resources.cpp \
     src/singletons/Settings.cpp \
+    src/singletons/SettingsSnapshot.cpp \
     src/singletons/Theme.cpp \
     src/singletons/Toasts.cpp \
     src/singletons/TooltipPreviewImage.cpp \
@@ -289,6 +300,7 @@ SOURCES += \
     src/widgets/helper/DebugPopup.cpp \
     src/widgets/helper/EditableModelView.cpp \
     src/widgets/helper/EffectLabel.cpp \
+    src/widgets/helper/EmoteGridView.cpp \
     src/widgets/helper/NotebookButton.cpp \
     src/widgets/helper/NotebookTab.cpp \
     src/widgets/helper/QColorPicker.cpp \
@@ -347,6 +359,7 @@ HEADERS += \
     src/common/CompletionModel.hpp \
     src/common/ConcurrentMap.hpp \
     src/common/Credentials.hpp \
+    src/common/DiskCache.hpp \
     src/common/DownloadManager.hpp \
     src/common/Env.hpp \
     src/common/FlagsEnum.hpp \
@@ -399,11 +412,19 @@ HEADERS += \
     src/controllers/taggedusers/TaggedUsersModel.hpp \
     src/debug/AssertInGuiThread.hpp \
     src/debug/Benchmark.hpp \
+    src/debug/FrameStats.hpp \
     src/ForwardDecl.hpp \
     src/messages/Emote.hpp \
+    src/messages/EmoteSnapshot.hpp \
     src/messages/Image.hpp \
+    src/messages/ImageLoader.hpp \
+    src/messages/ImageMemoryManager.hpp \
+    src/messages/ImageRegistry.hpp \
+    src/messages/ImageUploader.hpp \
     src/messages/ImageSet.hpp \
+    src/messages/layouts/ImageAtlas.hpp \
     src/messages/layouts/MessageLayout.hpp \
+    src/messages/layouts/MessageLayoutCache.hpp \
     src/messages/layouts/MessageLayoutContainer.hpp \
     src/messages/layouts/MessageLayoutElement.hpp \
     src/messages/LimitedQueue.hpp \
@@ -443,6 +464,7 @@ HEADERS += \
     src/providers/LinkResolver.hpp \
     src/providers/twitch/api/Helix.hpp \
     src/providers/twitch/api/Kraken.hpp \
+    src/providers/twitch/ChannelImagePrefetcher.hpp \
     src/providers/twitch/ChannelPointReward.hpp \
     src/providers/twitch/ChatterinoWebSocketppLogger.hpp \
     src/providers/twitch/EmoteValue.hpp \
@@ -472,6 +494,7 @@ HEADERS += \
     src/singletons/Paths.hpp \
     src/singletons/Resources.hpp \
     src/singletons/Settings.hpp \
+    src/singletons/SettingsSnapshot.hpp \
     src/singletons/Theme.hpp \
     src/singletons/Toasts.hpp \
     src/singletons/TooltipPreviewImage.hpp \
@@ -552,6 +575,7 @@ HEADERS += \
     src/widgets/helper/DebugPopup.hpp \
     src/widgets/helper/EditableModelView.hpp \
     src/widgets/helper/EffectLabel.hpp \
+    src/widgets/helper/EmoteGridView.hpp \
     src/widgets/helper/Line.hpp \
     src/widgets/helper/NotebookButton.hpp \
     src/widgets/helper/NotebookTab.hpp \
@@ -3,6 +3,7 @@
 #include <atomic>
 
 #include "common/Args.hpp"
+#include "common/DiskCache.hpp"
 #include "common/QLogging.hpp"
 #include "common/Version.hpp"
 #include "controllers/accounts/AccountController.hpp"
@@ -10,6 +11,7 @@
 #include "controllers/ignores/IgnoreController.hpp"
 #include "controllers/notifications/NotificationController.hpp"
 #include "debug/AssertInGuiThread.hpp"
+#include "messages/ImageUploader.hpp"
 #include "messages/MessageBuilder.hpp"
 #include "providers/bttv/BttvEmotes.hpp"
 #include "providers/chatterino/ChatterinoBadges.hpp"
@@ -105,6 +107,11 @@ void Application::initialize(Settings &settings, Paths &paths)
         }
     }
 
+    // images are decoded on other threads, the uploader has to be created
+    // here for its timer to belong to the gui thread
+    ImageUploader::instance();
+    DiskCache::instance().followSettings();
+
     for (auto &singleton : this->singletons_)
     {
         singleton->initialize(settings, paths);
@@ -0,0 +1,1005 @@
+#include "common/DiskCache.hpp"
+
+#include "common/QLogging.hpp"
+#include "debug/AssertInGuiThread.hpp"
+#include "singletons/Paths.hpp"
+#include "singletons/Settings.hpp"
+#include "util/DebugCount.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace chatterino {
+namespace {
+
+    constexpr quint32 indexMagic = 0x43485443;  // "CHTC"
+    // bump when the format changes, older caches are discarded
+    constexpr quint32 indexVersion = 1;
+    constexpr quint32 initialSlotCount = 1 << 14;
+    constexpr int writesPerMaintenance = 64;
+    // slots the maintenance looks at before letting reads and writes in
+    constexpr quint32 slotsPerLock = 1024;
+    constexpr int keySize = 32;
+    constexpr int contentHashSize = 20;
+    constexpr int maxEtagSize = 44;
+
+    enum SlotState : quint8 {
+        Empty = 0,
+        Used = 1,
+        Deleted = 2,
+    };
+
+    quint64 makeLocation(quint32 segment, quint32 offset)
+    {
+        return quint64(segment) << 32 | offset;
+    }
+
+    qint64 secondsNow()
+    {
+        return QDateTime::currentMSecsSinceEpoch() / 1000;
+    }
+
+    QByteArray normalizeKey(const QByteArray &key)
+    {
+        if (key.size() == keySize)
+        {
+            return key;
+        }
+        return QCryptographicHash::hash(key, QCryptographicHash::Sha256);
+    }
+
+    quint32 probeStart(const char *key, quint32 slotCount)
+    {
+        quint64 bits;
+        std::memcpy(&bits, key, sizeof(bits));
+        return quint32(bits & (slotCount - 1));
+    }
+
+    // Responses used to be stored as one file each, named by the hex hash of
+    // their request.
+    void removeLegacyEntries(const QString &directory)
+    {
+        QtConcurrent::run([directory] {
+            static const QRegularExpression legacyName("^[0-9a-f]{64}$");
+
+            QDir dir(directory);
+            for (const auto &name : dir.entryList(QDir::Files))
+            {
+                if (legacyName.match(name).hasMatch())
+                {
+                    dir.remove(name);
+                }
+            }
+        });
+    }
+
+}  // namespace
+
+struct DiskCache::IndexHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 slotCount;
+    quint32 reserved[13];
+};
+
+struct DiskCache::IndexSlot {
+    char key[keySize];
+    quint32 segment;
+    quint32 offset;
+    quint32 size;
+    quint16 status;
+    quint8 etagSize;
+    quint8 state;
+    // seconds since epoch
+    qint64 storedAt;
+    qint64 lastUsed;
+    char contentHash[contentHashSize];
+    char etag[maxEtagSize];
+};
+
+DiskCache &DiskCache::instance()
+{
+    // leaked so responses finishing at exit can still be written
+    static DiskCache *instance = new DiskCache();
+    return *instance;
+}
+
+DiskCache::DiskCache()
+{
+    static_assert(sizeof(IndexHeader) == 64, "the index layout changed");
+    static_assert(sizeof(IndexSlot) == 128, "the index layout changed");
+}
+
+DiskCache::~DiskCache()
+{
+    QFuture<void> maintenance;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        maintenance = this->maintenance_;
+    }
+    maintenance.waitForFinished();
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->close();
+}
+
+void DiskCache::followSettings()
+{
+    assertInGuiThread();
+
+    removeLegacyEntries(getPaths()->cacheDirectory());
+
+    // opening reads the whole index, so it's done in the background
+    static QStringSetting cachePath("/cache/path");
+    cachePath.connect([this](auto, auto) {
+        QtConcurrent::run(
+            [this, directory = getPaths()->cacheDirectory() + "/http"] {
+                this->setDirectory(directory);
+            });
+    });
+
+    auto applyLimits = [this](auto, auto) {
+        auto maxBytes =
+            int64_t(getSettings()->diskCacheMaxSize.getValue()) * 1024 * 1024;
+        auto maxAgeDays = getSettings()->diskCacheMaxAge.getValue();
+        this->setLimits(maxBytes, std::chrono::hours(24 * maxAgeDays));
+    };
+    getSettings()->diskCacheMaxSize.connect(applyLimits);
+    getSettings()->diskCacheMaxAge.connect(applyLimits);
+}
+
+void DiskCache::setDirectory(const QString &directory)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (directory == this->directory_)
+    {
+        return;
+    }
+
+    this->close();
+    this->directory_ = directory;
+    this->open();
+}
+
+void DiskCache::setLimits(int64_t maxBytes, std::chrono::seconds maxAge,
+                          int64_t segmentSize)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->maxBytes_ = maxBytes;
+    this->maxAge_ = maxAge;
+    this->segmentSize_ = segmentSize;
+
+    // lower limits apply to the existing entries as well
+    this->scheduleMaintenance();
+}
+
+boost::optional<DiskCacheEntry> DiskCache::get(const QByteArray &key)
+{
+    auto normalized = normalizeKey(key);
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (this->slots_ == nullptr)
+    {
+        return boost::none;
+    }
+
+    auto *slot = this->find(normalized);
+    if (slot == nullptr)
+    {
+        DebugCount::increase("disk cache misses");
+        return boost::none;
+    }
+
+    auto now = secondsNow();
+    if (now - slot->storedAt > this->maxAge_.count())
+    {
+        this->removeSlot(*slot);
+        this->updateDebugCounts();
+        DebugCount::increase("disk cache misses");
+        return boost::none;
+    }
+
+    auto data =
+        this->read(makeLocation(slot->segment, slot->offset), slot->size);
+    if (data.size() != int(slot->size))
+    {
+        qCWarning(chatterinoCache) << "Couldn't read cached response";
+        this->removeSlot(*slot);
+        this->updateDebugCounts();
+        return boost::none;
+    }
+
+    slot->lastUsed = now;
+    DebugCount::increase("disk cache hits");
+
+    DiskCacheEntry entry;
+    entry.data = data;
+    entry.status = slot->status;
+    entry.etag = QByteArray(slot->etag, slot->etagSize);
+    entry.storedAt = QDateTime::fromMSecsSinceEpoch(slot->storedAt * 1000);
+    return entry;
+}
+
+void DiskCache::put(const QByteArray &key, const QByteArray &data, int status,
+                    const QByteArray &etag)
+{
+    // an empty body is most likely an error, so it isn't kept
+    if (data.isEmpty())
+    {
+        return;
+    }
+
+    auto normalized = normalizeKey(key);
+    auto contentHash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (this->slots_ == nullptr)
+    {
+        return;
+    }
+
+    auto writeMetadata = [&](IndexSlot &slot) {
+        slot.status = quint16(status);
+        // a cut off ETag would never match, so long ones aren't kept
+        slot.etagSize = etag.size() <= maxEtagSize ? quint8(etag.size()) : 0;
+        std::memcpy(slot.etag, etag.constData(), slot.etagSize);
+        slot.storedAt = slot.lastUsed = secondsNow();
+    };
+
+    if (auto *slot = this->find(normalized))
+    {
+        if (QByteArray::fromRawData(slot->contentHash, contentHashSize) ==
+            contentHash)
+        {
+            writeMetadata(*slot);
+            return;
+        }
+
+        this->removeSlot(*slot);
+    }
+
+    quint64 location;
+    auto existing = this->byContent_.find(contentHash);
+    if (existing != this->byContent_.end())
+    {
+        location = existing.value();
+        DebugCount::increase("disk cache shared records");
+    }
+    else if (auto appended = this->append(data))
+    {
+        location = *appended;
+    }
+    else
+    {
+        return;
+    }
+
+    // might rebuild the index, so no slot pointers are kept across it
+    auto *slot = this->insert(normalized);
+    if (slot == nullptr)
+    {
+        return;
+    }
+
+    slot->segment = quint32(location >> 32);
+    slot->offset = quint32(location);
+    slot->size = quint32(data.size());
+    std::memcpy(slot->contentHash, contentHash.constData(), contentHashSize);
+    writeMetadata(*slot);
+
+    this->addRef(location, quint32(data.size()), contentHash);
+
+    if (++this->writesSinceMaintenance_ >= writesPerMaintenance ||
+        this->liveBytes_ > this->maxBytes_)
+    {
+        this->scheduleMaintenance();
+    }
+
+    this->updateDebugCounts();
+}
+
+void DiskCache::remove(const QByteArray &key)
+{
+    auto normalized = normalizeKey(key);
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (this->slots_ == nullptr)
+    {
+        return;
+    }
+
+    if (auto *slot = this->find(normalized))
+    {
+        this->removeSlot(*slot);
+        this->updateDebugCounts();
+    }
+}
+
+void DiskCache::open()
+{
+    if (this->directory_.isEmpty())
+    {
+        return;
+    }
+
+    QDir().mkpath(this->directory_);
+
+    if (!this->mapIndex())
+    {
+        qCDebug(chatterinoCache)
+            << "Creating a new disk cache in" << this->directory_;
+
+        this->reset();
+
+        if (!this->mapIndex())
+        {
+            qCWarning(chatterinoCache)
+                << "Couldn't open the disk cache in" << this->directory_;
+            return;
+        }
+    }
+
+    this->generation_++;
+    this->loadState();
+    this->scheduleMaintenance();
+}
+
+void DiskCache::close()
+{
+    this->generation_++;
+
+    if (this->header_ != nullptr)
+    {
+        this->index_.unmap(reinterpret_cast<uchar *>(this->header_));
+    }
+    this->index_.close();
+
+    this->header_ = nullptr;
+    this->slots_ = nullptr;
+    this->slotCount_ = 0;
+    this->usedSlots_ = 0;
+    this->deletedSlots_ = 0;
+
+    this->records_.clear();
+    this->byContent_.clear();
+    this->segments_.clear();
+    this->writeSegment_ = 0;
+    this->liveBytes_ = 0;
+
+    this->updateDebugCounts();
+}
+
+void DiskCache::reset()
+{
+    QDir dir(this->directory_);
+    for (const auto &name : dir.entryList(QDir::Files))
+    {
+        dir.remove(name);
+    }
+
+    this->writeIndex({}, initialSlotCount);
+}
+
+bool DiskCache::mapIndex()
+{
+    this->index_.setFileName(this->directory_ + "/index");
+    if (!this->index_.open(QIODevice::ReadWrite))
+    {
+        return false;
+    }
+
+    auto size = this->index_.size();
+    auto *mapped = size >= qint64(sizeof(IndexHeader))
+                       ? this->index_.map(0, size)
+                       : nullptr;
+    if (mapped == nullptr)
+    {
+        this->index_.close();
+        return false;
+    }
+
+    auto *header = reinterpret_cast<IndexHeader *>(mapped);
+    auto slotCount = header->slotCount;
+
+    if (header->magic != indexMagic || header->version != indexVersion ||
+        slotCount == 0 || (slotCount & (slotCount - 1)) != 0 ||
+        size != qint64(sizeof(IndexHeader)) +
+                    qint64(slotCount) * qint64(sizeof(IndexSlot)))
+    {
+        this->index_.unmap(mapped);
+        this->index_.close();
+        return false;
+    }
+
+    this->header_ = header;
+    this->slots_ =
+        reinterpret_cast<IndexSlot *>(mapped + sizeof(IndexHeader));
+    this->slotCount_ = slotCount;
+
+    return true;
+}
+
+bool DiskCache::writeIndex(const std::vector<IndexSlot> &slots,
+                           quint32 slotCount)
+{
+    QByteArray buffer(int(sizeof(IndexHeader) + slotCount * sizeof(IndexSlot)),
+                      '\0');
+
+    auto *header = reinterpret_cast<IndexHeader *>(buffer.data());
+    header->magic = indexMagic;
+    header->version = indexVersion;
+    header->slotCount = slotCount;
+
+    auto *newSlots =
+        reinterpret_cast<IndexSlot *>(buffer.data() + sizeof(IndexHeader));
+
+    for (const auto &slot : slots)
+    {
+        auto i = probeStart(slot.key, slotCount);
+        while (newSlots[i].state != Empty)
+        {
+            i = (i + 1) & (slotCount - 1);
+        }
+        newSlots[i] = slot;
+    }
+
+    // the old index stays intact until the new one is complete
+    QSaveFile file(this->directory_ + "/index");
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    file.write(buffer);
+    return file.commit();
+}
+
+bool DiskCache::rebuildIndex(quint32 slotCount)
+{
+    std::vector<IndexSlot> used;
+    used.reserve(this->usedSlots_);
+
+    for (quint32 i = 0; i < this->slotCount_; i++)
+    {
+        if (this->slots_[i].state == Used)
+        {
+            used.push_back(this->slots_[i]);
+        }
+    }
+
+    this->index_.unmap(reinterpret_cast<uchar *>(this->header_));
+    this->index_.close();
+    this->header_ = nullptr;
+    this->slots_ = nullptr;
+
+    if (!this->writeIndex(used, slotCount) || !this->mapIndex())
+    {
+        qCWarning(chatterinoCache) << "Couldn't grow the disk cache index";
+
+        // starts over from whichever index is on disk now
+        this->close();
+        this->open();
+        return false;
+    }
+
+    this->usedSlots_ = quint32(used.size());
+    this->deletedSlots_ = 0;
+
+    return true;
+}
+
+void DiskCache::loadState()
+{
+    QDir dir(this->directory_);
+    for (const auto &name : dir.entryList({"segment-*"}, QDir::Files))
+    {
+        bool ok = false;
+        auto id = name.mid(int(strlen("segment-"))).toUInt(&ok);
+        if (ok)
+        {
+            this->openSegment(id);
+        }
+    }
+
+    for (quint32 i = 0; i < this->slotCount_; i++)
+    {
+        auto &slot = this->slots_[i];
+
+        if (slot.state == Deleted)
+        {
+            this->deletedSlots_++;
+        }
+        if (slot.state != Used)
+        {
+            continue;
+        }
+
+        auto segment = this->segments_.find(slot.segment);
+        if (segment == this->segments_.end() || slot.size == 0 ||
+            qint64(slot.offset) + slot.size > segment->second.file->size())
+        {
+            slot.state = Deleted;
+            this->deletedSlots_++;
+            continue;
+        }
+
+        this->usedSlots_++;
+        this->addRef(makeLocation(slot.segment, slot.offset), slot.size,
+                     QByteArray(slot.contentHash, contentHashSize));
+    }
+
+    // segments nothing points to were left behind by a crash
+    for (auto it = this->segments_.begin(); it != this->segments_.end();)
+    {
+        if (it->second.liveBytes == 0)
+        {
+            it->second.file->remove();
+            it = this->segments_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    this->writeSegment_ =
+        this->segments_.empty() ? 0 : this->segments_.rbegin()->first;
+
+    this->updateDebugCounts();
+}
+
+DiskCache::IndexSlot *DiskCache::find(const QByteArray &key) const
+{
+    auto mask = this->slotCount_ - 1;
+    auto i = probeStart(key.constData(), this->slotCount_);
+
+    for (quint32 n = 0; n < this->slotCount_; n++, i = (i + 1) & mask)
+    {
+        auto &slot = this->slots_[i];
+
+        if (slot.state == Empty)
+        {
+            return nullptr;
+        }
+        if (slot.state == Used &&
+            std::memcmp(slot.key, key.constData(), keySize) == 0)
+        {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+DiskCache::IndexSlot *DiskCache::insert(const QByteArray &key)
+{
+    // deleted slots make lookups longer just like used ones, they are only
+    // dropped when the index is rebuilt
+    if ((quint64(this->usedSlots_) + this->deletedSlots_ + 1) * 10 >
+        quint64(this->slotCount_) * 7)
+    {
+        auto grow = (quint64(this->usedSlots_) + 1) * 20 >
+                    quint64(this->slotCount_) * 7;
+        if (!this->rebuildIndex(grow ? this->slotCount_ * 2
+                                     : this->slotCount_))
+        {
+            return nullptr;
+        }
+    }
+
+    auto mask = this->slotCount_ - 1;
+    auto i = probeStart(key.constData(), this->slotCount_);
+    while (this->slots_[i].state == Used)
+    {
+        i = (i + 1) & mask;
+    }
+
+    auto &slot = this->slots_[i];
+    if (slot.state == Deleted)
+    {
+        this->deletedSlots_--;
+    }
+    this->usedSlots_++;
+
+    std::memcpy(slot.key, key.constData(), keySize);
+    slot.state = Used;
+
+    return &slot;
+}
+
+void DiskCache::removeSlot(IndexSlot &slot)
+{
+    this->release(makeLocation(slot.segment, slot.offset));
+
+    slot.state = Deleted;
+    this->usedSlots_--;
+    this->deletedSlots_++;
+}
+
+boost::optional<quint64> DiskCache::append(const QByteArray &data)
+{
+    auto *segment = &this->openSegment(this->writeSegment_);
+    if (segment->file->size() > 0 &&
+        segment->file->size() + data.size() > this->segmentSize_)
+    {
+        this->writeSegment_++;
+        segment = &this->openSegment(this->writeSegment_);
+    }
+
+    auto &file = *segment->file;
+    auto offset = file.size();
+
+    if (!file.seek(offset) || file.write(data) != data.size())
+    {
+        qCWarning(chatterinoCache)
+            << "Couldn't write to" << file.fileName() << file.errorString();
+        file.resize(offset);
+        return boost::none;
+    }
+
+    return makeLocation(this->writeSegment_, quint32(offset));
+}
+
+QByteArray DiskCache::read(quint64 location, quint32 size)
+{
+    auto segment = this->segments_.find(quint32(location >> 32));
+    if (segment == this->segments_.end())
+    {
+        return {};
+    }
+
+    auto &file = *segment->second.file;
+    if (!file.seek(qint64(quint32(location))))
+    {
+        return {};
+    }
+
+    return file.read(size);
+}
+
+void DiskCache::addRef(quint64 location, quint32 size,
+                       const QByteArray &contentHash)
+{
+    auto &record = this->records_[location];
+    if (record.refs++ > 0)
+    {
+        return;
+    }
+
+    record.size = size;
+    record.contentHash = contentHash;
+    this->byContent_.insert(contentHash, location);
+
+    this->segments_[quint32(location >> 32)].liveBytes += size;
+    this->liveBytes_ += size;
+}
+
+void DiskCache::release(quint64 location)
+{
+    auto it = this->records_.find(location);
+    if (it == this->records_.end() || --it->refs > 0)
+    {
+        return;
+    }
+
+    auto segment = this->segments_.find(quint32(location >> 32));
+    if (segment != this->segments_.end())
+    {
+        segment->second.liveBytes -= it->size;
+    }
+    this->liveBytes_ -= it->size;
+
+    auto content = this->byContent_.find(it->contentHash);
+    if (content != this->byContent_.end() && content.value() == location)
+    {
+        this->byContent_.erase(content);
+    }
+
+    this->records_.erase(it);
+}
+
+DiskCache::Segment &DiskCache::openSegment(quint32 id)
+{
+    auto &segment = this->segments_[id];
+
+    if (!segment.file)
+    {
+        segment.file = std::make_unique<QFile>(this->segmentPath(id));
+        if (!segment.file->open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+        {
+            qCWarning(chatterinoCache)
+                << "Couldn't open" << segment.file->fileName()
+                << segment.file->errorString();
+        }
+    }
+
+    return segment;
+}
+
+QString DiskCache::segmentPath(quint32 id) const
+{
+    return this->directory_ + "/segment-" + QString::number(id);
+}
+
+void DiskCache::maintain()
+{
+    std::lock_guard<std::mutex> maintenanceLock(this->maintenanceMutex_);
+
+    this->expire();
+    this->evict();
+    this->compact();
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->updateDebugCounts();
+}
+
+void DiskCache::scheduleMaintenance()
+{
+    this->writesSinceMaintenance_ = 0;
+
+    if (this->maintenanceScheduled_)
+    {
+        return;
+    }
+    this->maintenanceScheduled_ = true;
+
+    this->maintenance_ = QtConcurrent::run([this] {
+        this->maintain();
+
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->maintenanceScheduled_ = false;
+    });
+}
+
+void DiskCache::expire()
+{
+    // the index might be rebuilt between two chunks, the entries that are
+    // missed that way are expired next time
+    for (quint32 start = 0;; start += slotsPerLock)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (start >= this->slotCount_)
+        {
+            return;
+        }
+
+        auto cutoff = secondsNow() - this->maxAge_.count();
+        auto end = std::min(this->slotCount_, start + slotsPerLock);
+
+        for (auto i = start; i < end; i++)
+        {
+            auto &slot = this->slots_[i];
+            if (slot.state == Used && slot.storedAt < cutoff)
+            {
+                this->removeSlot(slot);
+            }
+        }
+    }
+}
+
+void DiskCache::evict()
+{
+    int64_t target = 0;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (this->liveBytes_ <= this->maxBytes_)
+        {
+            return;
+        }
+
+        // leave some room, so the next few writes don't evict again
+        target = this->maxBytes_ / 10 * 9;
+    }
+
+    std::vector<std::pair<QByteArray, qint64>> used;
+    for (quint32 start = 0;; start += slotsPerLock)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (start >= this->slotCount_)
+        {
+            break;
+        }
+
+        auto end = std::min(this->slotCount_, start + slotsPerLock);
+        for (auto i = start; i < end; i++)
+        {
+            const auto &slot = this->slots_[i];
+            if (slot.state == Used)
+            {
+                used.emplace_back(QByteArray(slot.key, keySize),
+                                  slot.lastUsed);
+            }
+        }
+    }
+
+    std::sort(used.begin(), used.end(), [](auto &&a, auto &&b) {
+        return a.second < b.second;
+    });
+
+    for (const auto &[key, lastUsed] : used)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (this->liveBytes_ <= target)
+        {
+            break;
+        }
+
+        // entries that were used since are kept
+        auto *slot = this->find(key);
+        if (slot != nullptr && slot->lastUsed == lastUsed)
+        {
+            this->removeSlot(*slot);
+        }
+    }
+}
+
+void DiskCache::compact()
+{
+    quint32 candidate = 0;
+    uint64_t generation = 0;
+    std::vector<quint64> locations;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        for (auto it = this->segments_.begin(); it != this->segments_.end();)
+        {
+            if (it->first != this->writeSegment_ && it->second.liveBytes == 0)
+            {
+                it->second.file->remove();
+                it = this->segments_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // only the segment with the most unused bytes is copied
+        int64_t candidateDeadBytes = 0;
+
+        for (const auto &[id, segment] : this->segments_)
+        {
+            auto size = segment.file->size();
+            auto deadBytes = size - segment.liveBytes;
+
+            if (id != this->writeSegment_ && deadBytes > size / 2 &&
+                deadBytes > candidateDeadBytes)
+            {
+                candidate = id;
+                candidateDeadBytes = deadBytes;
+            }
+        }
+
+        if (candidateDeadBytes == 0)
+        {
+            return;
+        }
+
+        for (auto it = this->records_.begin(); it != this->records_.end();
+             ++it)
+        {
+            if (quint32(it.key() >> 32) == candidate)
+            {
+                locations.push_back(it.key());
+            }
+        }
+
+        generation = this->generation_;
+    }
+
+    // the records are copied one at a time, until all of them are moved the
+    // slots keep pointing to the old copies
+    QHash<quint64, quint64> moved;
+    for (auto location : locations)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (this->generation_ != generation)
+        {
+            return;
+        }
+
+        auto record = this->records_.find(location);
+        if (record == this->records_.end())
+        {
+            // removed in the meantime
+            continue;
+        }
+
+        auto size = record->size;
+        auto data = this->read(location, size);
+        if (data.size() != int(size))
+        {
+            // slots pointing to it are removed below
+            continue;
+        }
+
+        auto copied = this->append(data);
+        if (!copied)
+        {
+            // tried again during the next maintenance
+            return;
+        }
+        moved.insert(location, *copied);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (this->generation_ != generation)
+    {
+        return;
+    }
+
+    for (quint32 i = 0; i < this->slotCount_; i++)
+    {
+        auto &slot = this->slots_[i];
+        if (slot.state != Used || slot.segment != candidate)
+        {
+            continue;
+        }
+
+        auto it = moved.find(makeLocation(slot.segment, slot.offset));
+        if (it == moved.end())
+        {
+            this->removeSlot(slot);
+            continue;
+        }
+
+        slot.segment = quint32(it.value() >> 32);
+        slot.offset = quint32(it.value());
+    }
+
+    for (auto it = moved.begin(); it != moved.end(); ++it)
+    {
+        // removed while it was copied, the copy isn't used
+        if (!this->records_.contains(it.key()))
+        {
+            continue;
+        }
+
+        auto record = this->records_.take(it.key());
+        this->records_.insert(it.value(), record);
+        this->byContent_.insert(record.contentHash, it.value());
+        this->segments_[quint32(it.value() >> 32)].liveBytes += record.size;
+    }
+
+    auto segment = this->segments_.find(candidate);
+    if (segment != this->segments_.end())
+    {
+        segment->second.file->remove();
+        this->segments_.erase(segment);
+    }
+
+    DebugCount::increase("disk cache compactions");
+}
+
+void DiskCache::updateDebugCounts()
+{
+    auto entries = int64_t(this->usedSlots_);
+    auto kib = this->liveBytes_ / 1024;
+
+    DebugCount::increase("disk cache entries",
+                         entries - this->reportedEntries_);
+    DebugCount::increase("disk cache KiB", kib - this->reportedKiB_);
+
+    this->reportedEntries_ = entries;
+    this->reportedKiB_ = kib;
+}
+
+}  // namespace chatterino
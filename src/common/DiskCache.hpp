@@ -0,0 +1,153 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chatterino {
+
+struct DiskCacheEntry {
+    QByteArray data;
+    int status = 200;
+    QByteArray etag;
+    QDateTime storedAt;
+};
+
+/// Keeps cached http responses in a few large files instead of one file per
+/// response.
+///
+/// Response bodies are appended to segment files of up to 64 MiB. A memory
+/// mapped index with open addressing maps the key of a response to its
+/// place in a segment together with its status, ETag and the time it was
+/// stored and last used. Responses with identical bodies share one record.
+///
+/// Once the live bytes exceed the size limit, the least recently used
+/// entries are removed, and entries older than the age limit are removed
+/// regardless. Segments that are mostly unused are compacted one at a time
+/// by copying their live records to the current segment. This maintenance
+/// runs in the background every few writes and only locks the cache for a
+/// few records at a time.
+///
+/// Any thread.
+class DiskCache : boost::noncopyable
+{
+public:
+    static constexpr int64_t defaultSegmentSize = int64_t(64) * 1024 * 1024;
+
+    // Doesn't cache anything until followSettings was called.
+    static DiskCache &instance();
+
+    DiskCache();
+    ~DiskCache();
+
+    // Uses the "http" directory inside the cache directory and the limits
+    // of the settings, now and whenever they change. Gui thread only.
+    void followSettings();
+
+    // Closes the current directory and opens `directory`. An index that
+    // can't be read discards the whole cache.
+    void setDirectory(const QString &directory);
+    // A new segment is started once the current one would grow beyond
+    // `segmentSize`.
+    void setLimits(int64_t maxBytes, std::chrono::seconds maxAge,
+                   int64_t segmentSize = defaultSegmentSize);
+
+    // Keys of any length work, 32 bytes (e.g. a SHA-256) are used as is.
+    boost::optional<DiskCacheEntry> get(const QByteArray &key);
+    void put(const QByteArray &key, const QByteArray &data, int status,
+             const QByteArray &etag = {});
+    void remove(const QByteArray &key);
+
+    // Expires, evicts and compacts right away. Waits for a maintenance that
+    // is running in the background.
+    void maintain();
+
+private:
+    struct IndexHeader;
+    struct IndexSlot;
+
+    struct Record {
+        quint32 size = 0;
+        int refs = 0;
+        QByteArray contentHash;
+    };
+
+    struct Segment {
+        std::unique_ptr<QFile> file;
+        int64_t liveBytes = 0;
+    };
+
+    void open();
+    void close();
+    void reset();
+    bool mapIndex();
+    bool writeIndex(const std::vector<IndexSlot> &slots, quint32 slotCount);
+    bool rebuildIndex(quint32 slotCount);
+    void loadState();
+
+    IndexSlot *find(const QByteArray &key) const;
+    IndexSlot *insert(const QByteArray &key);
+    void removeSlot(IndexSlot &slot);
+
+    // the location of a record is its segment in the high and its offset in
+    // the low 32 bits
+    boost::optional<quint64> append(const QByteArray &data);
+    QByteArray read(quint64 location, quint32 size);
+    void addRef(quint64 location, quint32 size, const QByteArray &contentHash);
+    void release(quint64 location);
+    Segment &openSegment(quint32 id);
+    QString segmentPath(quint32 id) const;
+
+    // Runs maintain in the background unless it's already scheduled.
+    // `mutex_` must be locked.
+    void scheduleMaintenance();
+    void expire();
+    void evict();
+    void compact();
+    void updateDebugCounts();
+
+    mutable std::mutex mutex_;
+    // held for a whole maintenance, so only one runs at a time
+    std::mutex maintenanceMutex_;
+    QFuture<void> maintenance_;
+    bool maintenanceScheduled_ = false;
+
+    QString directory_;
+    // changes whenever the directory is opened or closed
+    uint64_t generation_ = 0;
+    int64_t maxBytes_ = int64_t(1024) * 1024 * 1024;
+    std::chrono::seconds maxAge_ = std::chrono::hours(24 * 30);
+    int64_t segmentSize_ = defaultSegmentSize;
+
+    QFile index_;
+    IndexHeader *header_ = nullptr;
+    IndexSlot *slots_ = nullptr;
+    quint32 slotCount_ = 0;
+    quint32 usedSlots_ = 0;
+    quint32 deletedSlots_ = 0;
+
+    QHash<quint64, Record> records_;
+    // by the SHA-1 of the data
+    QHash<QByteArray, quint64> byContent_;
+    std::map<quint32, Segment> segments_;
+    quint32 writeSegment_ = 0;
+    int64_t liveBytes_ = 0;
+    int writesSinceMaintenance_ = 0;
+
+    int64_t reportedEntries_ = 0;
+    int64_t reportedKiB_ = 0;
+};
+
+}  // namespace chatterino
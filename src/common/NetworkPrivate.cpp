@@ -1,15 +1,14 @@
 #include "common/NetworkPrivate.hpp"
 
+#include "common/DiskCache.hpp"
 #include "common/NetworkManager.hpp"
 #include "common/NetworkResult.hpp"
 #include "common/Outcome.hpp"
 #include "debug/AssertInGuiThread.hpp"
-#include "singletons/Paths.hpp"
 #include "util/DebugCount.hpp"
 #include "util/PostToThread.hpp"
 
 #include <QCryptographicHash>
-#include <QFile>
 #include <QNetworkReply>
 #include <QtConcurrent>
 #include "common/QLogging.hpp"
@@ -56,18 +55,14 @@ QString NetworkData::getHash()
 }
 
 void writeToCache(const std::shared_ptr<NetworkData> &data,
-                  const QByteArray &bytes)
+                  const QByteArray &bytes, int status, const QByteArray &etag)
 {
     if (data->cache_)
     {
-        QtConcurrent::run([data, bytes] {
-            QFile cachedFile(getPaths()->cacheDirectory() + "/" +
-                             data->getHash());
-
-            if (cachedFile.open(QIODevice::WriteOnly))
-            {
-                cachedFile.write(bytes);
-            }
+        QtConcurrent::run([data, bytes, status, etag] {
+            DiskCache::instance().put(
+                QByteArray::fromHex(data->getHash().toLatin1()), bytes, status,
+                etag);
         });
     }
 }
@@ -203,12 +198,12 @@ void loadUncached(const std::shared_ptr<NetworkData> &data)
                 return;
             }
 
-            QByteArray bytes = reply->readAll();
-            writeToCache(data, bytes);
-
             auto status =
                 reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
 
+            QByteArray bytes = reply->readAll();
+            writeToCache(data, bytes, status.toInt(), reply->rawHeader("ETag"));
+
             NetworkResult result(bytes, status.toInt());
 
             DebugCount::increase("http request success");
@@ -272,19 +267,18 @@ void loadUncached(const std::shared_ptr<NetworkData> &data)
 // First tried to load cached, then uncached.
 void loadCached(const std::shared_ptr<NetworkData> &data)
 {
-    QFile cachedFile(getPaths()->cacheDirectory() + "/" + data->getHash());
+    auto cached = DiskCache::instance().get(
+        QByteArray::fromHex(data->getHash().toLatin1()));
 
-    if (!cachedFile.exists() || !cachedFile.open(QIODevice::ReadOnly))
+    if (!cached)
     {
-        // File didn't exist OR File could not be opened
+        // Not cached, expired or unreadable
         loadUncached(data);
         return;
     }
     else
     {
-        // XXX: check if bytes is empty?
-        QByteArray bytes = cachedFile.readAll();
-        NetworkResult result(bytes, 200);
+        NetworkResult result(cached->data, cached->status);
 
         if (data->onSuccess_)
         {
@@ -0,0 +1,211 @@
+#include "debug/FrameStats.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+
+#include <QDateTime>
+#include <QJsonArray>
+
+#include <algorithm>
+
+namespace chatterino {
+
+//
+// ROLLING HISTOGRAM
+//
+
+RollingHistogram::RollingHistogram(size_t capacity)
+    : capacity_(std::max(size_t(1), capacity))
+{
+}
+
+void RollingHistogram::add(double value)
+{
+    if (this->samples_.size() < this->capacity_)
+    {
+        this->samples_.push_back(value);
+    }
+    else
+    {
+        this->samples_[this->next_] = value;
+    }
+
+    this->next_ = (this->next_ + 1) % this->capacity_;
+}
+
+double RollingHistogram::percentile(double p) const
+{
+    if (this->samples_.empty())
+    {
+        return 0;
+    }
+
+    auto sorted = this->samples_;
+    auto index = std::min(sorted.size() - 1,
+                          size_t(p / 100 * double(sorted.size())));
+
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+
+    return sorted[index];
+}
+
+size_t RollingHistogram::count() const
+{
+    return this->samples_.size();
+}
+
+QString RollingHistogram::getDebugText(const QString &name) const
+{
+    return QString("  %1 p50 %2 p95 %3 p99 %4\n")
+        .arg(name, -18)
+        .arg(this->percentile(50), 7, 'f', 2)
+        .arg(this->percentile(95), 7, 'f', 2)
+        .arg(this->percentile(99), 7, 'f', 2);
+}
+
+QJsonObject RollingHistogram::toJson() const
+{
+    auto max = this->samples_.empty() ? 0.0
+                                      : *std::max_element(this->samples_.begin(),
+                                                          this->samples_.end());
+
+    return QJsonObject{
+        {"p50", this->percentile(50)},
+        {"p95", this->percentile(95)},
+        {"p99", this->percentile(99)},
+        {"max", max},
+        {"samples", int(this->samples_.size())},
+    };
+}
+
+//
+// VIEW FRAME STATS
+//
+
+void ViewFrameStats::setName(const QString &name)
+{
+    this->name_ = name;
+}
+
+const QString &ViewFrameStats::getName() const
+{
+    return this->name_;
+}
+
+void ViewFrameStats::addPaint(double milliseconds, int buffersRebuilt,
+                              bool animated)
+{
+    this->paintMs_.add(milliseconds);
+    this->buffersRebuilt_.add(buffersRebuilt);
+
+    this->paints_++;
+    this->totalBuffersRebuilt_ += uint64_t(buffersRebuilt);
+
+    if (animated)
+    {
+        this->animatedPaints_++;
+    }
+}
+
+void ViewFrameStats::addLayout(double milliseconds, int messagesLaidOut)
+{
+    this->layoutMs_.add(milliseconds);
+    this->messagesLaidOut_.add(messagesLaidOut);
+
+    this->layouts_++;
+    this->totalMessagesLaidOut_ += uint64_t(messagesLaidOut);
+}
+
+QString ViewFrameStats::getDebugText() const
+{
+    auto name = this->name_.isEmpty() ? QString("<empty>") : this->name_;
+
+    return QString("%1: %2 paints (%3 animated), %4 layouts\n")
+               .arg(name)
+               .arg(this->paints_)
+               .arg(this->animatedPaints_)
+               .arg(this->layouts_) +
+           this->paintMs_.getDebugText("paint ms") +
+           this->layoutMs_.getDebugText("layout ms") +
+           this->messagesLaidOut_.getDebugText("messages laid out") +
+           this->buffersRebuilt_.getDebugText("buffers rebuilt");
+}
+
+QJsonObject ViewFrameStats::toJson() const
+{
+    return QJsonObject{
+        {"name", this->name_},
+        {"paints", qint64(this->paints_)},
+        {"animatedPaints", qint64(this->animatedPaints_)},
+        {"layouts", qint64(this->layouts_)},
+        {"totalBuffersRebuilt", qint64(this->totalBuffersRebuilt_)},
+        {"totalMessagesLaidOut", qint64(this->totalMessagesLaidOut_)},
+        {"paintMs", this->paintMs_.toJson()},
+        {"layoutMs", this->layoutMs_.toJson()},
+        {"messagesLaidOut", this->messagesLaidOut_.toJson()},
+        {"buffersRebuilt", this->buffersRebuilt_.toJson()},
+    };
+}
+
+//
+// FRAME STATS
+//
+
+std::shared_ptr<ViewFrameStats> FrameStats::create()
+{
+    assertInGuiThread();
+
+    auto &views = FrameStats::views();
+
+    views.erase(std::remove_if(views.begin(), views.end(),
+                               [](auto &view) {
+                                   return view.expired();
+                               }),
+                views.end());
+
+    auto stats = std::make_shared<ViewFrameStats>();
+    views.push_back(stats);
+
+    return stats;
+}
+
+QString FrameStats::getDebugText()
+{
+    assertInGuiThread();
+
+    QString text;
+    for (auto &weak : FrameStats::views())
+    {
+        if (auto view = weak.lock())
+        {
+            text += view->getDebugText() + "\n";
+        }
+    }
+    return text;
+}
+
+QJsonObject FrameStats::toJson()
+{
+    assertInGuiThread();
+
+    QJsonArray views;
+    for (auto &weak : FrameStats::views())
+    {
+        if (auto view = weak.lock())
+        {
+            views.append(view->toJson());
+        }
+    }
+
+    return QJsonObject{
+        {"time", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"views", views},
+    };
+}
+
+std::vector<std::weak_ptr<ViewFrameStats>> &FrameStats::views()
+{
+    static std::vector<std::weak_ptr<ViewFrameStats>> views;
+    return views;
+}
+
+}  // namespace chatterino
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chatterino {
+
+// Keeps the last few samples of a value to compute percentiles over them.
+class RollingHistogram
+{
+public:
+    explicit RollingHistogram(size_t capacity = 600);
+
+    void add(double value);
+
+    // Returns the `p`th percentile (0 - 100) of the kept samples, or 0 if
+    // there are none.
+    double percentile(double p) const;
+    size_t count() const;
+
+    // "  <name> p50 .. p95 .. p99 ..", one line for the debug popup
+    QString getDebugText(const QString &name) const;
+    // {"p50": .., "p95": .., "p99": .., "max": .., "samples": ..}
+    QJsonObject toJson() const;
+
+private:
+    std::vector<double> samples_;
+    size_t capacity_;
+    size_t next_ = 0;
+};
+
+// Frame timings of a single ChannelView.
+class ViewFrameStats : boost::noncopyable
+{
+public:
+    void setName(const QString &name);
+    const QString &getName() const;
+
+    // A paint event of the view. `buffersRebuilt` is the number of message
+    // buffers that had to be redrawn, `animated` is true if the paint was
+    // caused by an animated emote advancing its frame.
+    void addPaint(double milliseconds, int buffersRebuilt, bool animated);
+    // A layout pass over the visible messages. `messagesLaidOut` is the
+    // number of messages that had to be laid out again.
+    void addLayout(double milliseconds, int messagesLaidOut);
+
+    QString getDebugText() const;
+    QJsonObject toJson() const;
+
+private:
+    QString name_;
+
+    RollingHistogram paintMs_;
+    RollingHistogram layoutMs_;
+    RollingHistogram messagesLaidOut_;
+    RollingHistogram buffersRebuilt_;
+
+    uint64_t paints_ = 0;
+    uint64_t animatedPaints_ = 0;
+    uint64_t layouts_ = 0;
+    uint64_t totalBuffersRebuilt_ = 0;
+    uint64_t totalMessagesLaidOut_ = 0;
+};
+
+// Collects the frame stats of all views for the debug popup.
+//
+// Gui thread only.
+class FrameStats
+{
+public:
+    // Creates stats for a view. They are listed until the view drops them.
+    static std::shared_ptr<ViewFrameStats> create();
+
+    static QString getDebugText();
+    static QJsonObject toJson();
+
+private:
+    static std::vector<std::weak_ptr<ViewFrameStats>> &views();
+};
+
+}  // namespace chatterino
@@ -0,0 +1,174 @@
+#include "messages/EmoteSnapshot.hpp"
+
+#include "common/QLogging.hpp"
+#include "singletons/Paths.hpp"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+
+    constexpr quint32 snapshotMagic = 0x43454d53;  // "CEMS"
+    // bump when the format changes, older snapshots are ignored
+    constexpr quint32 snapshotVersion = 1;
+
+    QString snapshotPath(const QString &name)
+    {
+        return getPaths()->cacheDirectory() + "/emote-snapshots/" + name +
+               ".bin";
+    }
+
+    void writeImage(QDataStream &stream, const ImagePtr &image)
+    {
+        stream << image->url().string << double(image->scale());
+    }
+
+    ImagePtr readImage(QDataStream &stream)
+    {
+        QString url;
+        double scale;
+        stream >> url >> scale;
+
+        if (url.isEmpty())
+        {
+            return Image::getEmpty();
+        }
+        return Image::fromUrl({url}, scale);
+    }
+
+}  // namespace
+
+void writeEmoteSnapshot(const QString &name, const EmoteSnapshot &snapshot)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    stream << snapshotMagic << snapshotVersion << quint32(snapshot.size());
+
+    for (const auto &[key, emote] : snapshot)
+    {
+        stream << key << emote->name.string;
+        writeImage(stream, emote->images.getImage1());
+        writeImage(stream, emote->images.getImage2());
+        writeImage(stream, emote->images.getImage3());
+        stream << emote->tooltip.string << emote->homePage.string;
+    }
+
+    QtConcurrent::run([path = snapshotPath(name), data] {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        QSaveFile file(path);
+        if (file.open(QIODevice::WriteOnly))
+        {
+            file.write(data);
+            file.commit();
+        }
+    });
+}
+
+boost::optional<EmoteSnapshot> readEmoteSnapshot(const QString &name)
+{
+    QFile file(snapshotPath(name));
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+    {
+        return boost::none;
+    }
+
+    // the strings are copied out while reading, so the mapping can go away
+    // with the file
+    QByteArray data;
+    if (auto *mapped = file.map(0, file.size()))
+    {
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped),
+                                       int(file.size()));
+    }
+    else
+    {
+        data = file.readAll();
+    }
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic, version, count;
+    stream >> magic >> version >> count;
+
+    if (magic != snapshotMagic || version != snapshotVersion)
+    {
+        return boost::none;
+    }
+
+    EmoteSnapshot snapshot;
+    // the count of a corrupt snapshot might be anything
+    snapshot.reserve(std::min<quint32>(count, 1 << 16));
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString key;
+        Emote emote;
+
+        stream >> key >> emote.name.string;
+        auto image1 = readImage(stream);
+        auto image2 = readImage(stream);
+        auto image3 = readImage(stream);
+        emote.images = ImageSet(image1, image2, image3);
+        stream >> emote.tooltip.string >> emote.homePage.string;
+
+        snapshot.emplace_back(key, std::make_shared<Emote>(std::move(emote)));
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        qCWarning(chatterinoCache) << "Emote snapshot" << name << "is corrupt";
+        return boost::none;
+    }
+
+    return snapshot;
+}
+
+void removeEmoteSnapshot(const QString &name)
+{
+    QtConcurrent::run([path = snapshotPath(name)] {
+        QFile::remove(path);
+    });
+}
+
+void writeEmoteMapSnapshot(const QString &name, const EmoteMap &emotes)
+{
+    EmoteSnapshot snapshot;
+    snapshot.reserve(emotes.size());
+
+    for (const auto &[emoteName, emote] : emotes)
+    {
+        snapshot.emplace_back(emoteName.string, emote);
+    }
+
+    writeEmoteSnapshot(name, snapshot);
+}
+
+boost::optional<EmoteMap> readEmoteMapSnapshot(const QString &name)
+{
+    auto snapshot = readEmoteSnapshot(name);
+    if (!snapshot)
+    {
+        return boost::none;
+    }
+
+    EmoteMap emotes;
+    for (auto &[key, emote] : *snapshot)
+    {
+        emotes[EmoteName{key}] = std::move(emote);
+    }
+
+    return emotes;
+}
+
+}  // namespace chatterino
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "messages/Emote.hpp"
+
+#include <QString>
+#include <boost/optional.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace chatterino {
+
+/// Parsed emotes and badges are written to small binary files in the cache
+/// directory, so they can be shown right after startup while they are
+/// fetched again.
+using EmoteSnapshot = std::vector<std::pair<QString, EmotePtr>>;
+
+// Writes `snapshot` as `name` in the background. Any thread.
+void writeEmoteSnapshot(const QString &name, const EmoteSnapshot &snapshot);
+// Reads the snapshot `name`. Returns boost::none if there is none or it
+// can't be read.
+boost::optional<EmoteSnapshot> readEmoteSnapshot(const QString &name);
+// Deletes the snapshot `name` in the background. Any thread.
+void removeEmoteSnapshot(const QString &name);
+
+// Same as above for emotes keyed by their name.
+void writeEmoteMapSnapshot(const QString &name, const EmoteMap &emotes);
+boost::optional<EmoteMap> readEmoteMapSnapshot(const QString &name);
+
+}  // namespace chatterino
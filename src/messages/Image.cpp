@@ -1,11 +1,13 @@
 #include "messages/Image.hpp"
 
 #include <QBuffer>
+#include <QCryptographicHash>
 #include <QImageReader>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QTimer>
+#include <QtConcurrent>
 #include <functional>
 #include <thread>
 
@@ -15,6 +17,9 @@
 #include "common/QLogging.hpp"
 #include "debug/AssertInGuiThread.hpp"
 #include "debug/Benchmark.hpp"
+#include "messages/ImageMemoryManager.hpp"
+#include "messages/ImageRegistry.hpp"
+#include "messages/ImageUploader.hpp"
 #ifndef CHATTERINO_TEST
 #    include "singletons/Emotes.hpp"
 #endif
@@ -23,10 +28,214 @@
 #include "util/DebugCount.hpp"
 #include "util/PostToThread.hpp"
 
-#include <queue>
-
 namespace chatterino {
 namespace detail {
+    namespace {
+        // frames decoded ahead of the current one of a FrameStream
+        constexpr int streamAheadFrames = 6;
+        // animations with more frames are decoded while they play
+        constexpr int streamMinFrames = 24;
+        // sizes an image keeps scaled frames for, e.g. for splits with
+        // different zoom levels
+        constexpr size_t maxScaledSizes = 2;
+
+        size_t pixmapBytes(const QPixmap &pixmap)
+        {
+            return size_t(pixmap.width()) * size_t(pixmap.height()) *
+                   size_t(std::max(1, pixmap.depth() / 8));
+        }
+    }  // namespace
+
+    // FrameStream
+    struct FrameStream::Decoder {
+        QByteArray data;
+        int count{0};
+        // gui thread, reset when the stream is destroyed
+        FrameStream *stream{nullptr};
+
+        // worker thread, there is only one decode per stream at a time
+        QBuffer buffer;
+        std::unique_ptr<QImageReader> reader;
+        // index of the frame reader returns next
+        int nextIndex{0};
+
+        void restart()
+        {
+            this->reader.reset();
+            this->buffer.close();
+
+            this->buffer.setData(this->data);
+            this->buffer.open(QIODevice::ReadOnly);
+            this->reader = std::make_unique<QImageReader>(&this->buffer);
+            this->nextIndex = 0;
+        }
+
+        QVector<Frame<QImage>> decode(int from, int frameCount)
+        {
+            QVector<Frame<QImage>> frames;
+
+            // seek to the requested frame, the frames in between are needed
+            // to decode it
+            if (this->reader == nullptr || this->nextIndex > from)
+            {
+                this->restart();
+            }
+
+            QImage image;
+            while (this->nextIndex < from)
+            {
+                if (!this->reader->read(&image))
+                {
+                    return frames;
+                }
+                this->nextIndex++;
+            }
+
+            while (frames.size() < frameCount)
+            {
+                // loop back to the start
+                if (this->nextIndex >= this->count)
+                {
+                    this->restart();
+                }
+
+                if (!this->reader->read(&image))
+                {
+                    break;
+                }
+
+                frames.push_back({image, 0});
+                this->nextIndex++;
+            }
+
+            return frames;
+        }
+    };
+
+    FrameStream::FrameStream(const QByteArray &data, QVector<int> durations,
+                             const QPixmap &first)
+        : durations_(std::move(durations))
+        , first_(first)
+        , last_(first)
+        , decoder_(std::make_shared<Decoder>())
+    {
+        this->decoder_->data = data;
+        this->decoder_->count = this->durations_.size();
+        this->decoder_->stream = this;
+
+        DebugCount::increase("streamed animations");
+    }
+
+    FrameStream::~FrameStream()
+    {
+        // a running decode drops its frames
+        this->decoder_->stream = nullptr;
+    }
+
+    int FrameStream::count() const
+    {
+        return this->durations_.size();
+    }
+
+    int FrameStream::duration(int index) const
+    {
+        return this->durations_[index];
+    }
+
+    const QPixmap &FrameStream::first() const
+    {
+        return this->first_;
+    }
+
+    QPixmap FrameStream::frame(int index)
+    {
+        if (this->failed_)
+        {
+            return this->first_;
+        }
+
+        // frames before the requested one aren't needed anymore
+        auto it = std::find_if(this->ring_.begin(), this->ring_.end(),
+                               [index](auto &&frame) {
+                                   return frame.first == index;
+                               });
+        this->ring_.erase(this->ring_.begin(), it);
+
+        if (this->ring_.empty())
+        {
+            // we were paused or skipped frames, keep showing the last frame
+            // until the requested one is decoded
+            this->decode(index, streamAheadFrames + 1);
+            return this->last_;
+        }
+
+        this->last_ = this->ring_.front().second;
+
+        if (int(this->ring_.size()) <= streamAheadFrames)
+        {
+            this->decode((this->ring_.back().first + 1) % this->count(),
+                         streamAheadFrames + 1 - int(this->ring_.size()));
+        }
+
+        return this->last_;
+    }
+
+    size_t FrameStream::bytes() const
+    {
+        return size_t(this->decoder_->data.size()) +
+               pixmapBytes(this->first_) * size_t(streamAheadFrames + 2);
+    }
+
+    void FrameStream::decode(int from, int count)
+    {
+        if (this->decoding_)
+        {
+            return;
+        }
+        this->decoding_ = true;
+
+        QtConcurrent::run([decoder = this->decoder_, from, count] {
+            auto frames = decoder->decode(from, count);
+
+            ImageUploader::instance().push(
+                std::move(frames),
+                [weak = std::weak_ptr<Decoder>(decoder),
+                 from](const auto &decoded) {
+                    auto decoder = weak.lock();
+                    if (decoder && decoder->stream)
+                    {
+                        decoder->stream->receive(from, decoded);
+                    }
+                });
+        });
+    }
+
+    void FrameStream::receive(int from, const QVector<Frame<QPixmap>> &frames)
+    {
+        this->decoding_ = false;
+
+        if (frames.empty())
+        {
+            qCDebug(chatterinoImage) << "Error while decoding streamed frames";
+            this->failed_ = true;
+            this->ring_.clear();
+            return;
+        }
+
+        // the frames don't follow the ones we have, we skipped ahead since
+        if (!this->ring_.empty() &&
+            (this->ring_.back().first + 1) % this->count() != from)
+        {
+            return;
+        }
+
+        for (int i = 0; i < frames.size(); i++)
+        {
+            this->ring_.emplace_back((from + i) % this->count(),
+                                     frames[i].image);
+        }
+    }
+
     // Frames
     Frames::Frames()
     {
@@ -35,6 +244,17 @@ namespace detail {
 
     Frames::Frames(const QVector<Frame<QPixmap>> &frames)
         : items_(frames)
+    {
+        this->initialize();
+    }
+
+    Frames::Frames(std::unique_ptr<FrameStream> stream)
+        : stream_(std::move(stream))
+    {
+        this->initialize();
+    }
+
+    void Frames::initialize()
     {
         assertInGuiThread();
         DebugCount::increase("images");
@@ -51,25 +271,12 @@ namespace detail {
 #endif
         }
 
-        auto totalLength =
-            std::accumulate(this->items_.begin(), this->items_.end(), 0UL,
-                            [](auto init, auto &&frame) {
-                                return init + frame.duration;
-                            });
-
-        if (totalLength == 0)
+        for (int i = 0; i < this->count(); i++)
         {
-            this->durationOffset_ = 0;
+            this->totalLength_ += this->duration(i);
         }
-        else
-        {
-#ifndef CHATTERINO_TEST
-            this->durationOffset_ = std::min<int>(
-                int(getApp()->emotes->gifTimer.position() % totalLength),
-                60000);
-#endif
-        }
-        this->processOffset();
+
+        this->advance();
     }
 
     Frames::~Frames()
@@ -83,56 +290,173 @@ namespace detail {
         }
 
         this->gifTimerConnection_.disconnect();
+
+#ifndef CHATTERINO_TEST
+        ImageMemoryManager::instance().remove(this);
+#endif
     }
 
     void Frames::advance()
     {
-        this->durationOffset_ += gifFrameLength;
-        this->processOffset();
+#ifndef CHATTERINO_TEST
+        this->processOffset(getApp()->emotes->gifTimer.position());
+#else
+        this->processOffset(0);
+#endif
+    }
+
+    int Frames::count() const
+    {
+        return this->stream_ ? this->stream_->count() : this->items_.size();
     }
 
-    void Frames::processOffset()
+    int Frames::duration(int index) const
     {
-        if (this->items_.isEmpty())
+        return this->stream_ ? this->stream_->duration(index)
+                             : this->items_[index].duration;
+    }
+
+    void Frames::processOffset(long unsigned position)
+    {
+        if (this->count() == 0 || this->totalLength_ == 0)
         {
             return;
         }
 
-        while (true)
+        // all images loop on the same global clock, so identical emotes
+        // stay in sync
+        auto offset = position % this->totalLength_;
+
+        this->index_ = 0;
+        while (offset >=
+               static_cast<long unsigned>(this->duration(this->index_)))
         {
-            this->index_ %= this->items_.size();
+            offset -= this->duration(this->index_);
+            this->index_++;
+        }
 
-            if (this->durationOffset_ > this->items_[this->index_].duration)
-            {
-                this->durationOffset_ -= this->items_[this->index_].duration;
-                this->index_ = (this->index_ + 1) % this->items_.size();
-            }
-            else
-            {
-                break;
-            }
+        this->nextFrameAt_ = position - offset + this->duration(this->index_);
+    }
+
+    void Frames::scheduleNextFrame() const
+    {
+        if (!this->animated())
+        {
+            return;
         }
+
+#ifndef CHATTERINO_TEST
+        getApp()->emotes->gifTimer.scheduleAt(this->nextFrameAt_);
+#endif
     }
 
     bool Frames::animated() const
     {
-        return this->items_.size() > 1;
+        return this->count() > 1;
+    }
+
+    size_t Frames::bytes() const
+    {
+        if (this->stream_)
+        {
+            return this->stream_->bytes() + this->scaledBytes_;
+        }
+
+        size_t bytes = this->scaledBytes_;
+        for (const auto &frame : this->items_)
+        {
+            bytes += pixmapBytes(frame.image);
+        }
+        return bytes;
     }
 
     boost::optional<QPixmap> Frames::current() const
     {
+        if (this->stream_)
+        {
+            // decoding only happens for images that are painted
+            return this->stream_->frame(this->index_);
+        }
+
         if (this->items_.size() == 0)
             return boost::none;
         return this->items_[this->index_].image;
     }
 
+    boost::optional<QPixmap> Frames::currentScaled(const QSize &size) const
+    {
+        auto pixmap = this->current();
+        if (!pixmap || size.isEmpty() || pixmap->size() == size)
+        {
+            return pixmap;
+        }
+
+        auto it = std::find_if(this->scaled_.begin(), this->scaled_.end(),
+                               [&](auto &&scaled) {
+                                   return scaled.size == size;
+                               });
+
+        auto scaledBytes = this->scaledBytes_;
+
+        if (it == this->scaled_.end())
+        {
+            if (this->scaled_.size() >= maxScaledSizes)
+            {
+                for (const auto &frame : this->scaled_.front().frames)
+                {
+                    this->scaledBytes_ -= pixmapBytes(frame);
+                }
+                this->scaled_.erase(this->scaled_.begin());
+            }
+
+            this->scaled_.push_back(
+                {size, QVector<QPixmap>(this->stream_ ? 1 : this->count())});
+            it = std::prev(this->scaled_.end());
+        }
+
+        auto &frame = it->frames[this->stream_ ? 0 : this->index_];
+        if (frame.isNull() ||
+            (this->stream_ && it->streamIndex != this->index_))
+        {
+            this->scaledBytes_ -= pixmapBytes(frame);
+            frame = pixmap->scaled(size, Qt::IgnoreAspectRatio,
+                                   Qt::SmoothTransformation);
+            this->scaledBytes_ += pixmapBytes(frame);
+            it->streamIndex = this->index_;
+        }
+
+#ifndef CHATTERINO_TEST
+        if (this->scaledBytes_ != scaledBytes)
+        {
+            ImageMemoryManager::instance().resize(this);
+        }
+#endif
+
+        return frame;
+    }
+
     boost::optional<QPixmap> Frames::first() const
     {
+        if (this->stream_)
+        {
+            return this->stream_->first();
+        }
+
         if (this->items_.size() == 0)
             return boost::none;
         return this->items_.front().image;
     }
 
+    void Frames::markUsed() const
+    {
+        this->lastUsed_ = std::chrono::steady_clock::now();
+    }
+
+    std::chrono::steady_clock::time_point Frames::lastUsed() const
+    {
+        return this->lastUsed_;
+    }
+
     // functions
     QVector<Frame<QImage>> readFrames(QImageReader &reader, const Url &url)
     {
@@ -168,74 +492,57 @@ namespace detail {
         return frames;
     }
 
-    // parsed
-    template <typename Assign>
-    void assignDelayed(
-        std::queue<std::pair<Assign, QVector<Frame<QPixmap>>>> &queued,
-        std::mutex &mutex, std::atomic_bool &loadedEventQueued)
+    // Reads the durations of all frames but only decodes the first one.
+    std::pair<QImage, QVector<int>> readStreamedFrames(QImageReader &reader,
+                                                       const Url &url)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        int i = 0;
+        QImage first;
+        QVector<int> durations;
 
-        while (!queued.empty())
+        QImage image;
+        for (int index = 0; index < reader.imageCount(); ++index)
         {
-            queued.front().first(queued.front().second);
-            queued.pop();
-
-            if (++i > 50)
+            if (index == 0)
             {
-                QTimer::singleShot(3, [&] {
-                    assignDelayed(queued, mutex, loadedEventQueued);
-                });
-                return;
+                if (!reader.read(&first))
+                {
+                    break;
+                }
+            }
+            // formats that can't skip frames have to decode them
+            else if (!reader.jumpToNextImage() && !reader.read(&image))
+            {
+                break;
             }
-        }
-
-#ifndef CHATTERINO_TEST
-        getApp()->windows->forceLayoutChannelViews();
-#endif
-        loadedEventQueued = false;
-    }
-
-    template <typename Assign>
-    auto makeConvertCallback(const QVector<Frame<QImage>> &parsed,
-                             Assign assign)
-    {
-        return [parsed, assign] {
-            // convert to pixmap
-            auto frames = QVector<Frame<QPixmap>>();
-            std::transform(parsed.begin(), parsed.end(),
-                           std::back_inserter(frames), [](auto &frame) {
-                               return Frame<QPixmap>{
-                                   QPixmap::fromImage(frame.image),
-                                   frame.duration};
-                           });
-
-            // put into stack
-            static std::queue<std::pair<Assign, QVector<Frame<QPixmap>>>>
-                queued;
-            static std::mutex mutex;
-
-            std::lock_guard<std::mutex> lock(mutex);
-            queued.emplace(assign, frames);
 
-            static std::atomic_bool loadedEventQueued{false};
+            durations.push_back(std::max(20, reader.nextImageDelay()));
+        }
 
-            if (!loadedEventQueued)
-            {
-                loadedEventQueued = true;
+        if (durations.size() == 0)
+        {
+            qCDebug(chatterinoImage)
+                << "Error while reading image" << url.string << ": '"
+                << reader.errorString() << "'";
+        }
 
-                QTimer::singleShot(100, [=] {
-                    assignDelayed(queued, mutex, loadedEventQueued);
-                });
-            }
-        };
+        return {first, durations};
     }
 }  // namespace detail
 
 // IMAGE2
 Image::~Image()
 {
+    if (this->registered_)
+    {
+        ImageRegistry::instance().released(this);
+    }
+
+    // nobody waits for the request anymore, let the next one start
+    if (this->loadSlot_)
+    {
+        this->loadSlot_->release();
+    }
+
     if (this->empty_)
     {
         // No data in this image, don't bother trying to release it
@@ -246,27 +553,19 @@ Image::~Image()
     // run destructor of Frames in gui thread
     if (!isGuiThread())
     {
-        postToThread([frames = this->frames_.release()]() {
-            delete frames;
+        postToThread([frames = std::move(this->frames_)]() mutable {
+            frames.reset();
         });
     }
 }
 
 ImagePtr Image::fromUrl(const Url &url, qreal scale)
 {
-    static std::unordered_map<Url, std::weak_ptr<Image>> cache;
-    static std::mutex mutex;
-
-    std::lock_guard<std::mutex> lock(mutex);
-
-    auto shared = cache[url].lock();
-
-    if (!shared)
-    {
-        cache[url] = shared = ImagePtr(new Image(url, scale));
-    }
-
-    return shared;
+    return ImageRegistry::instance().getOrCreate(url, [&] {
+        auto image = ImagePtr(new Image(url, scale));
+        image->registered_ = true;
+        return image;
+    });
 }
 
 ImagePtr Image::fromPixmap(const QPixmap &pixmap, qreal scale)
@@ -293,20 +592,20 @@ Image::Image(const Url &url, qreal scale)
     : url_(url)
     , scale_(scale)
     , shouldLoad_(true)
-    , frames_(std::make_unique<detail::Frames>())
+    , frames_(std::make_shared<detail::Frames>())
 {
 }
 
 Image::Image(qreal scale)
     : scale_(scale)
-    , frames_(std::make_unique<detail::Frames>())
+    , frames_(std::make_shared<detail::Frames>())
 {
 }
 
 void Image::setPixmap(const QPixmap &pixmap)
 {
     auto setFrames = [shared = this->shared_from_this(), pixmap]() {
-        shared->frames_ = std::make_unique<detail::Frames>(
+        shared->frames_ = std::make_shared<detail::Frames>(
             QVector<detail::Frame<QPixmap>>{detail::Frame<QPixmap>{pixmap, 1}});
     };
 
@@ -336,20 +635,56 @@ boost::optional<QPixmap> Image::pixmapOrLoad() const
 {
     assertInGuiThread();
 
-    this->load();
+    this->load(ImageLoadPriority::Visible);
+    this->markUsed();
+    this->frames_->scheduleNextFrame();
 
     return this->frames_->current();
 }
 
-void Image::load() const
+boost::optional<QPixmap> Image::scaledPixmapOrLoad(const QSize &size) const
 {
     assertInGuiThread();
 
+    this->load(ImageLoadPriority::Visible);
+    this->markUsed();
+    this->frames_->scheduleNextFrame();
+
+    return this->frames_->currentScaled(size);
+}
+
+void Image::load(ImageLoadPriority priority) const
+{
+    assertInGuiThread();
+
+    auto *self = const_cast<Image *>(this);
+
     if (this->shouldLoad_)
     {
-        const_cast<Image *>(this)->shouldLoad_ = false;
-        const_cast<Image *>(this)->actuallyLoad();
+        self->shouldLoad_ = false;
+        self->queuedPriority_ = priority;
+        self->requestedAt_ = std::chrono::steady_clock::now();
+        ImageLoader::instance().request(self->shared_from_this(), priority);
     }
+    else if (this->queuedPriority_ && priority < *this->queuedPriority_)
+    {
+        self->queuedPriority_ = priority;
+        ImageLoader::instance().request(self->shared_from_this(), priority);
+    }
+}
+
+void Image::markUsed() const
+{
+    this->frames_->markUsed();
+}
+
+void Image::expireFrames()
+{
+    assertInGuiThread();
+
+    this->frames_ = std::make_shared<detail::Frames>();
+    this->shouldLoad_ = true;
+    this->queuedPriority_ = boost::none;
 }
 
 qreal Image::scale() const
@@ -391,23 +726,49 @@ int Image::height() const
 
 void Image::actuallyLoad()
 {
+    // frees the loader slot once the callbacks holding it are gone, i.e. when
+    // the image is downloaded and decoded or the request failed
+    auto slot = std::make_shared<ImageLoader::Slot>();
+    this->loadSlot_ = slot;
+
     NetworkRequest(this->url().string)
         .concurrent()
         .cache()
-        .onSuccess([weak = weakOf(this)](auto result) -> Outcome {
-            auto shared = weak.lock();
-            if (!shared)
+        .onSuccess([weak = weakOf(this), url = this->url(),
+                    slot](auto result) -> Outcome {
+            // the image isn't kept alive while decoding, the work is dropped
+            // if it's destroyed in the meantime
+            if (weak.expired())
                 return Failure;
 
             auto data = result.getData();
+            auto contentHash =
+                QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+            // the same bytes were already decoded for another url
+            if (ImageRegistry::instance().hasFrames(contentHash))
+            {
+                postToThread([weak, contentHash, slot] {
+                    if (auto shared = weak.lock())
+                    {
+                        shared->assignSharedFrames(contentHash);
+                    }
+                });
+
+                return Success;
+            }
 
             // const cast since we are only reading from it
             QBuffer buffer(const_cast<QByteArray *>(&data));
             buffer.open(QIODevice::ReadOnly);
             QImageReader reader(&buffer);
 
-            if (reader.size().width() * reader.size().height() *
-                    reader.imageCount() * 4 >
+            auto streamed = reader.imageCount() > detail::streamMinFrames;
+            auto framesInRam = streamed ? detail::streamAheadFrames + 2
+                                        : reader.imageCount();
+
+            if (reader.size().width() * reader.size().height() * framesInRam *
+                    4 >
                 Image::maxBytesRam)
             {
                 qCDebug(chatterinoImage) << "image too large in RAM";
@@ -415,16 +776,53 @@ void Image::actuallyLoad()
                 return Failure;
             }
 
-            auto parsed = detail::readFrames(reader, shared->url());
+            if (streamed)
+            {
+                auto parsed = detail::readStreamedFrames(reader, url);
+                auto durations = parsed.second;
+                if (durations.size() == 0)
+                {
+                    return Failure;
+                }
+
+                // only the first frame is converted now
+                QVector<detail::Frame<QImage>> first{
+                    {parsed.first, durations.front()}};
+
+                ImageUploader::instance().push(
+                    first,
+                    [weak, data, durations, contentHash](const auto &frames) {
+                        if (auto shared = weak.lock())
+                        {
+                            shared->assignFrames(
+                                std::make_shared<detail::Frames>(
+                                    std::make_unique<detail::FrameStream>(
+                                        data, durations,
+                                        frames.front().image)),
+                                contentHash);
+                        }
+                    });
+
+                return Success;
+            }
+
+            auto parsed = detail::readFrames(reader, url);
+            if (weak.expired())
+                return Failure;
 
-            postToThread(makeConvertCallback(parsed, [weak](auto frames) {
-                if (auto shared = weak.lock())
-                    shared->frames_ = std::make_unique<detail::Frames>(frames);
-            }));
+            ImageUploader::instance().push(
+                parsed, [weak, contentHash](const auto &frames) {
+                    if (auto shared = weak.lock())
+                    {
+                        shared->assignFrames(
+                            std::make_shared<detail::Frames>(frames),
+                            contentHash);
+                    }
+                });
 
             return Success;
         })
-        .onError([weak = weakOf(this)](auto /*result*/) {
+        .onError([weak = weakOf(this), slot](auto /*result*/) {
             auto shared = weak.lock();
             if (!shared)
                 return false;
@@ -437,6 +835,48 @@ void Image::actuallyLoad()
         .execute();
 }
 
+void Image::assignFrames(std::shared_ptr<detail::Frames> frames,
+                         const QByteArray &contentHash)
+{
+    assertInGuiThread();
+
+    this->frames_ = std::move(frames);
+    ImageRegistry::instance().addFrames(contentHash, this->frames_);
+
+#ifndef CHATTERINO_TEST
+    ImageMemoryManager::instance().add(this->shared_from_this());
+    ImageLoader::instance().addFirstPixel(this->requestedAt_);
+#endif
+}
+
+void Image::assignSharedFrames(const QByteArray &contentHash)
+{
+    assertInGuiThread();
+
+    auto frames = ImageRegistry::instance().getFrames(contentHash);
+    if (!frames)
+    {
+        // the other images were destroyed in the meantime, load again
+        this->shouldLoad_ = true;
+        return;
+    }
+
+    this->frames_ = std::move(frames);
+
+    DebugCount::increase("deduplicated images");
+    DebugCount::increase("deduplicated image KiB",
+                         int64_t(this->frames_->bytes() >> 10));
+
+#ifndef CHATTERINO_TEST
+    // the frames are only counted once
+    ImageMemoryManager::instance().add(this->shared_from_this());
+    ImageLoader::instance().addFirstPixel(this->requestedAt_);
+
+    // there is no upload for these, so lay out here
+    getApp()->windows->layoutChannelViews();
+#endif
+}
+
 bool Image::operator==(const Image &other) const
 {
     if (this->isEmpty() && other.isEmpty())
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QBuffer>
+#include <QImageReader>
 #include <QPixmap>
 #include <QString>
 #include <QThread>
@@ -8,12 +10,16 @@
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include <pajlada/signals/signal.hpp>
 
 #include "common/Aliases.hpp"
 #include "common/Common.hpp"
+#include "messages/ImageLoader.hpp"
 
 namespace chatterino {
 namespace detail {
@@ -22,23 +28,96 @@ namespace detail {
         Image image;
         int duration;
     };
+
+    // Decodes the frames of a long animation while it plays instead of all
+    // of them up front. Only the encoded data, the first frame and a few
+    // frames from the current one on are kept in memory. The frames are
+    // decoded ahead of time on a worker thread.
+    //
+    // Gui thread only.
+    class FrameStream : boost::noncopyable
+    {
+    public:
+        FrameStream(const QByteArray &data, QVector<int> durations,
+                    const QPixmap &first);
+        ~FrameStream();
+
+        int count() const;
+        int duration(int index) const;
+        const QPixmap &first() const;
+        // Returns frame `index` and requests the frames after it. Returns
+        // the last frame again if frame `index` isn't decoded yet, e.g.
+        // after the animation was paused.
+        QPixmap frame(int index);
+        size_t bytes() const;
+
+    private:
+        struct Decoder;
+
+        // Decodes `count` frames from `from` on unless a decode is running.
+        void decode(int from, int count);
+        void receive(int from, const QVector<Frame<QPixmap>> &frames);
+
+        QVector<int> durations_;
+        QPixmap first_;
+        // the frame that was returned last
+        QPixmap last_;
+
+        // shared with the running decode
+        std::shared_ptr<Decoder> decoder_;
+        bool decoding_{false};
+        // the data can't be decoded, only the first frame is shown
+        bool failed_{false};
+
+        // consecutive frames, starting with the one that was requested last
+        std::deque<std::pair<int, QPixmap>> ring_;
+    };
+
     class Frames : boost::noncopyable
     {
     public:
         Frames();
         Frames(const QVector<Frame<QPixmap>> &frames);
+        Frames(std::unique_ptr<FrameStream> stream);
         ~Frames();
 
         bool animated() const;
+        // Memory used by the decoded and scaled frames.
+        size_t bytes() const;
         void advance();
+        // Tells the gif timer when the next frame of this image is due.
+        void scheduleNextFrame() const;
         boost::optional<QPixmap> current() const;
+        // Returns the current frame scaled to `size` with a smooth filter.
+        // The scaled frames are kept for the last few sizes.
+        boost::optional<QPixmap> currentScaled(const QSize &size) const;
         boost::optional<QPixmap> first() const;
+        // Called when one of the images using the frames is painted.
+        void markUsed() const;
+        std::chrono::steady_clock::time_point lastUsed() const;
 
     private:
-        void processOffset();
+        void initialize();
+        int count() const;
+        int duration(int index) const;
+        void processOffset(long unsigned position);
         QVector<Frame<QPixmap>> items_;
+        // set instead of items_ for long animations
+        std::unique_ptr<FrameStream> stream_;
         int index_{0};
-        int durationOffset_{0};
+        long unsigned totalLength_{0};
+        // gif timer position at which the current frame ends
+        long unsigned nextFrameAt_{0};
+
+        struct Scaled {
+            QSize size;
+            // indexed by frame, long animations only keep the current one
+            QVector<QPixmap> frames;
+            int streamIndex{-1};
+        };
+        mutable std::vector<Scaled> scaled_;
+        mutable size_t scaledBytes_{0};
+        mutable std::chrono::steady_clock::time_point lastUsed_{};
         pajlada::Signals::Connection gifTimerConnection_;
     };
 }  // namespace detail
@@ -63,7 +142,14 @@ public:
     bool loaded() const;
     // either returns the current pixmap, or triggers loading it (lazy loading)
     boost::optional<QPixmap> pixmapOrLoad() const;
-    void load() const;
+    // Like pixmapOrLoad, but scaled to `size` in device pixels so it can be
+    // painted without scaling.
+    boost::optional<QPixmap> scaledPixmapOrLoad(const QSize &size) const;
+    void load(ImageLoadPriority priority = ImageLoadPriority::Background) const;
+    // Marks the image as painted. Images that weren't painted for a while
+    // might have their frames dropped to save memory, see
+    // ImageMemoryManager.
+    void markUsed() const;
     qreal scale() const;
     bool isEmpty() const;
     int width() const;
@@ -80,6 +166,13 @@ private:
 
     void setPixmap(const QPixmap &pixmap);
     void actuallyLoad();
+    // Sets frames decoded from bytes with `contentHash`.
+    void assignFrames(std::shared_ptr<detail::Frames> frames,
+                      const QByteArray &contentHash);
+    // Shares the frames of another image with the same content.
+    void assignSharedFrames(const QByteArray &contentHash);
+    // Drops the decoded frames, they are loaded again when needed.
+    void expireFrames();
 
     const Url url_{};
     const qreal scale_{1};
@@ -87,6 +180,17 @@ private:
 
     // gui thread only
     bool shouldLoad_{false};
-    std::unique_ptr<detail::Frames> frames_{};
+    // shared with images of identical content, see ImageRegistry
+    std::shared_ptr<detail::Frames> frames_{};
+    // set while the image waits in the ImageLoader
+    boost::optional<ImageLoadPriority> queuedPriority_;
+    std::chrono::steady_clock::time_point requestedAt_{};
+    // set while the image is loading, released when it's destroyed
+    std::shared_ptr<ImageLoader::Slot> loadSlot_;
+    // true if the image is in the ImageRegistry
+    bool registered_ = false;
+
+    friend class ImageMemoryManager;
+    friend class ImageLoader;
 };
 }  // namespace chatterino
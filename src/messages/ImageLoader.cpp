@@ -0,0 +1,138 @@
+#include "messages/ImageLoader.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+#include "messages/Image.hpp"
+#include "singletons/Settings.hpp"
+#include "util/DebugCount.hpp"
+#include "util/PostToThread.hpp"
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+
+    double millisecondsSince(ImageLoader::Clock::time_point time)
+    {
+        return std::chrono::duration<double, std::milli>(
+                   ImageLoader::Clock::now() - time)
+            .count();
+    }
+
+}  // namespace
+
+ImageLoader::Slot::~Slot()
+{
+    this->release();
+}
+
+void ImageLoader::Slot::release()
+{
+    if (!this->released_.exchange(true))
+    {
+        postToThread([] {
+            ImageLoader::instance().finished();
+        });
+    }
+}
+
+ImageLoader &ImageLoader::instance()
+{
+    static ImageLoader *instance = new ImageLoader();
+    return *instance;
+}
+
+ImageLoader::ImageLoader()
+{
+    this->startTimer_.setSingleShot(true);
+    this->startTimer_.setInterval(0);
+    QObject::connect(&this->startTimer_, &QTimer::timeout, [this] {
+        this->startNext();
+    });
+}
+
+void ImageLoader::request(const std::shared_ptr<Image> &image,
+                          ImageLoadPriority priority)
+{
+    assertInGuiThread();
+
+    this->queues_[int(priority)].push_back(Job{image, Clock::now()});
+    DebugCount::increase("image loads queued");
+
+    if (!this->startTimer_.isActive())
+    {
+        this->startTimer_.start();
+    }
+}
+
+void ImageLoader::finished()
+{
+    assertInGuiThread();
+
+    this->running_--;
+    DebugCount::decrease("image loads running");
+
+    this->startNext();
+}
+
+void ImageLoader::addFirstPixel(Clock::time_point requestedAt)
+{
+    this->timeToFirstPixelMs_.add(millisecondsSince(requestedAt));
+}
+
+void ImageLoader::startNext()
+{
+    auto limit = std::max(1, getSettings()->imageLoadConcurrency.getValue());
+
+    for (int priority = 0; priority < 3 && this->running_ < limit;)
+    {
+        auto &queue = this->queues_[priority];
+        if (queue.empty())
+        {
+            priority++;
+            continue;
+        }
+
+        auto job = std::move(queue.front());
+        queue.pop_front();
+        DebugCount::decrease("image loads queued");
+
+        auto image = job.image.lock();
+        if (!image)
+        {
+            this->cancelled_++;
+            continue;
+        }
+
+        // the image was moved up into another queue, or is loaded already
+        if (!image->queuedPriority_ ||
+            int(*image->queuedPriority_) != priority)
+        {
+            continue;
+        }
+
+        image->queuedPriority_ = boost::none;
+        this->queueWaitMs_.add(millisecondsSince(job.queuedAt));
+        this->running_++;
+        this->started_++;
+        DebugCount::increase("image loads running");
+
+        image->actuallyLoad();
+    }
+}
+
+QString ImageLoader::getDebugText() const
+{
+    return QString("image loads: %1 visible, %2 near, %3 background waiting, "
+                   "%4 running\n"
+                   "  %5 started, %6 cancelled\n")
+               .arg(this->queues_[int(ImageLoadPriority::Visible)].size())
+               .arg(this->queues_[int(ImageLoadPriority::Near)].size())
+               .arg(this->queues_[int(ImageLoadPriority::Background)].size())
+               .arg(this->running_)
+               .arg(this->started_)
+               .arg(this->cancelled_) +
+           this->queueWaitMs_.getDebugText("queue wait ms") +
+           this->timeToFirstPixelMs_.getDebugText("first pixel ms");
+}
+
+}  // namespace chatterino
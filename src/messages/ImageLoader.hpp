@@ -0,0 +1,92 @@
+#pragma once
+
+#include "debug/FrameStats.hpp"
+
+#include <QString>
+#include <QTimer>
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace chatterino {
+
+class Image;
+
+enum class ImageLoadPriority {
+    // painted right now
+    Visible,
+    // about to be scrolled into view
+    Near,
+    // e.g. laid out messages that might never be shown
+    Background,
+};
+
+/// Starts the requests of images loaded from urls. At most
+/// "imageLoadConcurrency" images are downloaded and decoded at once, the
+/// others wait in one queue per priority. Images that are destroyed while
+/// waiting are never requested, images that are destroyed while loading free
+/// their place right away.
+///
+/// Gui thread only.
+class ImageLoader : boost::noncopyable
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // The place of a running request. It's freed when the request is done or
+    // the image is destroyed, whichever happens first.
+    class Slot : boost::noncopyable
+    {
+    public:
+        ~Slot();
+
+        // Any thread, only the first call frees the place.
+        void release();
+
+    private:
+        std::atomic_bool released_{false};
+    };
+
+    static ImageLoader &instance();
+
+    // Queues `image` to be loaded. Requesting a waiting image again with a
+    // higher priority moves it up.
+    void request(const std::shared_ptr<Image> &image,
+                 ImageLoadPriority priority);
+    // Called when the slot of a request started by the loader is released.
+    void finished();
+    // Called when the first frame of an image that was requested at
+    // `requestedAt` is available.
+    void addFirstPixel(Clock::time_point requestedAt);
+
+    QString getDebugText() const;
+
+private:
+    ImageLoader();
+
+    void startNext();
+
+    struct Job {
+        std::weak_ptr<Image> image;
+        Clock::time_point queuedAt;
+    };
+
+    // indexed by ImageLoadPriority
+    std::deque<Job> queues_[3];
+    int running_ = 0;
+    uint64_t started_ = 0;
+    uint64_t cancelled_ = 0;
+
+    RollingHistogram queueWaitMs_;
+    RollingHistogram timeToFirstPixelMs_;
+
+    // starts requests once all the requests of the current event loop
+    // iteration are queued, so they are started in order of priority
+    QTimer startTimer_;
+};
+
+}  // namespace chatterino
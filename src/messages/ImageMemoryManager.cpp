@@ -0,0 +1,185 @@
+#include "messages/ImageMemoryManager.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+#include "messages/Image.hpp"
+#include "singletons/Settings.hpp"
+#include "util/DebugCount.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace chatterino {
+namespace {
+
+    // images painted this recently are never dropped, even if that means
+    // going over the budget
+    constexpr auto minUnusedTime = std::chrono::seconds(10);
+    // free a bit more than needed so we don't drop images on every load
+    constexpr double targetUsage = 0.9;
+
+    size_t budget()
+    {
+        return size_t(std::max(1, getSettings()->imageMemoryBudget.getValue()))
+               << 20;
+    }
+
+}  // namespace
+
+ImageMemoryManager &ImageMemoryManager::instance()
+{
+    static ImageMemoryManager *instance = new ImageMemoryManager();
+    return *instance;
+}
+
+ImageMemoryManager::ImageMemoryManager()
+{
+    this->evictTimer_.setSingleShot(true);
+    QObject::connect(&this->evictTimer_, &QTimer::timeout, [this] {
+        this->evict();
+    });
+}
+
+void ImageMemoryManager::add(const std::shared_ptr<Image> &image)
+{
+    assertInGuiThread();
+
+    const auto &frames = image->frames_;
+    auto it = this->entries_.find(frames.get());
+    if (it == this->entries_.end())
+    {
+        auto bytes = frames->bytes();
+        it = this->entries_
+                 .emplace(frames.get(), Entry{frames, bytes, {}})
+                 .first;
+        this->usedBytes_ += bytes;
+        DebugCount::increase("decoded image KiB", int64_t(bytes >> 10));
+    }
+
+    // the image was requested because it's about to be painted
+    frames->markUsed();
+
+    auto &users = it->second.users;
+    users.erase(std::remove_if(users.begin(), users.end(),
+                               [](auto &&user) {
+                                   return user.expired();
+                               }),
+                users.end());
+    users.push_back(image);
+
+    if (this->usedBytes_ > budget())
+    {
+        this->scheduleEviction();
+    }
+}
+
+void ImageMemoryManager::resize(const detail::Frames *frames)
+{
+    assertInGuiThread();
+
+    auto it = this->entries_.find(frames);
+    if (it == this->entries_.end())
+    {
+        return;
+    }
+
+    auto bytes = frames->bytes();
+    this->usedBytes_ = this->usedBytes_ - it->second.bytes + bytes;
+    DebugCount::decrease("decoded image KiB", int64_t(it->second.bytes >> 10));
+    DebugCount::increase("decoded image KiB", int64_t(bytes >> 10));
+    it->second.bytes = bytes;
+
+    if (this->usedBytes_ > budget())
+    {
+        this->scheduleEviction();
+    }
+}
+
+void ImageMemoryManager::remove(const detail::Frames *frames)
+{
+    assertInGuiThread();
+
+    auto it = this->entries_.find(frames);
+    if (it == this->entries_.end())
+    {
+        return;
+    }
+
+    this->usedBytes_ -= it->second.bytes;
+    DebugCount::decrease("decoded image KiB", int64_t(it->second.bytes >> 10));
+    this->entries_.erase(it);
+}
+
+size_t ImageMemoryManager::usedBytes() const
+{
+    return this->usedBytes_;
+}
+
+void ImageMemoryManager::scheduleEviction()
+{
+    if (!this->evictTimer_.isActive())
+    {
+        this->evictTimer_.start(1000);
+    }
+}
+
+void ImageMemoryManager::evict()
+{
+    assertInGuiThread();
+
+    if (this->usedBytes_ <= budget())
+    {
+        return;
+    }
+
+    auto target = size_t(double(budget()) * targetUsage);
+    auto unusedSince = Clock::now() - minUnusedTime;
+
+    // painting any of the images using the frames marks them as used
+    std::vector<std::pair<std::shared_ptr<detail::Frames>, Entry *>>
+        candidates;
+    for (auto &&[key, entry] : this->entries_)
+    {
+        auto frames = entry.frames.lock();
+        if (frames && frames->lastUsed() < unusedSince)
+        {
+            candidates.emplace_back(std::move(frames), &entry);
+        }
+    }
+
+    // least recently painted first
+    std::sort(candidates.begin(), candidates.end(), [](auto &&a, auto &&b) {
+        return a.first->lastUsed() < b.first->lastUsed();
+    });
+
+    for (auto &&[frames, entry] : candidates)
+    {
+        if (this->usedBytes_ <= target)
+        {
+            break;
+        }
+
+        // the entry is gone once the frames are destroyed
+        auto users = std::move(entry->users);
+        for (auto &&user : users)
+        {
+            auto image = user.lock();
+            if (image && image->frames_ == frames)
+            {
+                image->expireFrames();
+                DebugCount::increase("expired images");
+            }
+        }
+
+        // destroys the frames unless something else still holds them
+        frames.reset();
+    }
+
+    // the remaining images were painted too recently, try again later
+    if (this->usedBytes_ > budget())
+    {
+        this->evictTimer_.start(
+            int(std::chrono::milliseconds(minUnusedTime).count()));
+    }
+}
+
+}  // namespace chatterino
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QTimer>
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace chatterino {
+
+class Image;
+namespace detail {
+    class Frames;
+}  // namespace detail
+
+/// Keeps track of the memory used by the decoded frames of images loaded from
+/// a url. Once the total exceeds the "imageMemoryBudget" setting, the frames
+/// that weren't painted for the longest time are dropped. The images using
+/// them stay valid and load their frames again (usually from the disk cache)
+/// the next time they are painted.
+///
+/// Frames shared by images with identical content are counted once and only
+/// dropped if none of the images was painted recently.
+///
+/// Gui thread only.
+class ImageMemoryManager : boost::noncopyable
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static ImageMemoryManager &instance();
+
+    // Called when `image` got new frames, either decoded or shared with
+    // other images.
+    void add(const std::shared_ptr<Image> &image);
+    // Called when the memory used by `frames` changed, e.g. because scaled
+    // copies of them were added.
+    void resize(const detail::Frames *frames);
+    // Called when `frames` are destroyed.
+    void remove(const detail::Frames *frames);
+
+    size_t usedBytes() const;
+
+private:
+    ImageMemoryManager();
+
+    void scheduleEviction();
+    void evict();
+
+    struct Entry {
+        std::weak_ptr<detail::Frames> frames;
+        size_t bytes;
+        // the images that got the frames, some might use other frames by now
+        std::vector<std::weak_ptr<Image>> users;
+    };
+
+    std::unordered_map<const detail::Frames *, Entry> entries_;
+    size_t usedBytes_ = 0;
+
+    QTimer evictTimer_;
+};
+
+}  // namespace chatterino
@@ -0,0 +1,185 @@
+#include "messages/ImageRegistry.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+#include "messages/Image.hpp"
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+
+    // a shard is swept once this many images were added, or once it grew by
+    // half since the last sweep, whichever is more
+    constexpr size_t minInsertsPerSweep = 256;
+    // shards that rarely get new images are swept at least this often
+    constexpr auto maxSweepInterval = std::chrono::minutes(1);
+
+}  // namespace
+
+ImageRegistry &ImageRegistry::instance()
+{
+    // leaked so images destroyed at exit can still report to it
+    static ImageRegistry *instance = new ImageRegistry();
+    return *instance;
+}
+
+std::shared_ptr<Image> ImageRegistry::getOrCreate(
+    const Url &url, const std::function<std::shared_ptr<Image>()> &create)
+{
+    Key key{qHash(url.string), url.string};
+    auto &shard = this->shardFor(key.hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.images.find(key);
+    if (it != shard.images.end())
+    {
+        auto &entry = it->second;
+        if (auto shared = entry.image.lock())
+        {
+            return shared;
+        }
+
+        // reuse the entry of the destroyed image
+        auto shared = create();
+        if (entry.tombstone)
+        {
+            this->tombstones_--;
+        }
+        entry = Entry{shared, shared.get(), false};
+        this->live_++;
+
+        return shared;
+    }
+
+    auto shared = create();
+    shard.images.emplace(std::move(key), Entry{shared, shared.get(), false});
+    this->live_++;
+
+    shard.insertsSinceSweep++;
+    if (shard.insertsSinceSweep >=
+            std::max(minInsertsPerSweep, shard.images.size() / 2) ||
+        Clock::now() - shard.lastSweep > maxSweepInterval)
+    {
+        this->sweep(shard);
+    }
+
+    return shared;
+}
+
+void ImageRegistry::released(const Image *image)
+{
+    Key key{qHash(image->url().string), image->url().string};
+    auto &shard = this->shardFor(key.hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    this->live_--;
+
+    // the entry might have been swept or reused already once the image
+    // looked expired
+    auto it = shard.images.find(key);
+    if (it != shard.images.end() && it->second.address == image)
+    {
+        it->second.tombstone = true;
+        this->tombstones_++;
+    }
+}
+
+bool ImageRegistry::hasFrames(const QByteArray &contentHash) const
+{
+    std::lock_guard<std::mutex> lock(this->framesMutex_);
+
+    auto it = this->frames_.find(contentHash);
+    return it != this->frames_.end() && !it.value().expired();
+}
+
+std::shared_ptr<detail::Frames> ImageRegistry::getFrames(
+    const QByteArray &contentHash)
+{
+    assertInGuiThread();
+
+    std::lock_guard<std::mutex> lock(this->framesMutex_);
+
+    return this->frames_.value(contentHash).lock();
+}
+
+void ImageRegistry::addFrames(const QByteArray &contentHash,
+                              const std::shared_ptr<detail::Frames> &frames)
+{
+    assertInGuiThread();
+
+    std::lock_guard<std::mutex> lock(this->framesMutex_);
+
+    this->frames_.insert(contentHash, frames);
+
+    if (this->frames_.size() >= this->framesSweepAt_)
+    {
+        for (auto it = this->frames_.begin(); it != this->frames_.end();)
+        {
+            if (it.value().expired())
+            {
+                it = this->frames_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        this->framesSweepAt_ = std::max(256, this->frames_.size() * 2);
+    }
+}
+
+int64_t ImageRegistry::liveCount() const
+{
+    return this->live_;
+}
+
+int64_t ImageRegistry::tombstoneCount() const
+{
+    return this->tombstones_;
+}
+
+QString ImageRegistry::getDebugText() const
+{
+    return QString("image registry: %1 live, %2 tombstoned, %3 sweeps\n")
+        .arg(this->liveCount())
+        .arg(this->tombstoneCount())
+        .arg(this->sweeps_.load());
+}
+
+ImageRegistry::Shard &ImageRegistry::shardFor(size_t hash)
+{
+    // the low bits pick the bucket inside the shard
+    return this->shards_[(hash >> 16) % shardCount];
+}
+
+void ImageRegistry::sweep(Shard &shard)
+{
+    int64_t erased = 0;
+
+    for (auto it = shard.images.begin(); it != shard.images.end();)
+    {
+        if (it->second.image.expired())
+        {
+            if (it->second.tombstone)
+            {
+                erased++;
+            }
+            it = shard.images.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    this->tombstones_ -= erased;
+    this->sweeps_++;
+
+    shard.insertsSinceSweep = 0;
+    shard.lastSweep = Clock::now();
+}
+
+}  // namespace chatterino
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "common/Aliases.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <boost/noncopyable.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace chatterino {
+
+class Image;
+namespace detail {
+    class Frames;
+}  // namespace detail
+
+/// Maps urls to the images loaded from them so every url is only loaded
+/// once. The entries are split over a few independently locked shards, and
+/// entries of destroyed images are swept out of a shard every few inserts.
+///
+/// Decoded frames are also kept by a hash of the bytes they were decoded
+/// from, so images with identical content from different urls share them.
+///
+/// This class is thread safe.
+class ImageRegistry : boost::noncopyable
+{
+public:
+    static ImageRegistry &instance();
+
+    // Returns the image for `url` if it is still alive, otherwise stores and
+    // returns the result of `create`.
+    std::shared_ptr<Image> getOrCreate(
+        const Url &url, const std::function<std::shared_ptr<Image>()> &create);
+
+    // Called by the destructor of an image that was registered. Its entry
+    // only counts as a tombstone from here on, even though it might look
+    // expired a bit earlier.
+    void released(const Image *image);
+
+    // Returns true if frames decoded from bytes with `contentHash` are still
+    // alive. They might be gone by the time getFrames is called.
+    bool hasFrames(const QByteArray &contentHash) const;
+    // Gui thread only, so the frames are never released on another thread.
+    std::shared_ptr<detail::Frames> getFrames(const QByteArray &contentHash);
+    void addFrames(const QByteArray &contentHash,
+                   const std::shared_ptr<detail::Frames> &frames);
+
+    // images that are alive
+    int64_t liveCount() const;
+    // entries of destroyed images that weren't swept yet
+    int64_t tombstoneCount() const;
+
+    QString getDebugText() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ImageRegistry() = default;
+
+    struct Key {
+        // qHash of the url, computed once per lookup
+        size_t hash;
+        QString url;
+
+        bool operator==(const Key &other) const
+        {
+            return this->hash == other.hash && this->url == other.url;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const
+        {
+            return key.hash;
+        }
+    };
+
+    struct Entry {
+        std::weak_ptr<Image> image;
+        // only compared, the image might be destroyed
+        const Image *address = nullptr;
+        // true once the image ran released()
+        bool tombstone = false;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, KeyHash> images;
+        size_t insertsSinceSweep = 0;
+        Clock::time_point lastSweep = Clock::now();
+    };
+
+    static constexpr size_t shardCount = 16;
+
+    Shard &shardFor(size_t hash);
+    // Erases the entries of destroyed images. `shard` must be locked.
+    void sweep(Shard &shard);
+
+    std::array<Shard, shardCount> shards_;
+
+    mutable std::mutex framesMutex_;
+    QHash<QByteArray, std::weak_ptr<detail::Frames>> frames_;
+    // size at which frames_ is swept next
+    int framesSweepAt_ = 256;
+
+    std::atomic<int64_t> live_{0};
+    std::atomic<int64_t> tombstones_{0};
+    std::atomic<uint64_t> sweeps_{0};
+};
+
+}  // namespace chatterino
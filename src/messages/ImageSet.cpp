@@ -1,6 +1,7 @@
 #include "messages/ImageSet.hpp"
 
 #include "singletons/Settings.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 
 namespace chatterino {
 
@@ -61,7 +62,7 @@ const ImagePtr &ImageSet::getImage3() const
 const std::shared_ptr<Image> &getImagePriv(const ImageSet &set, float scale)
 {
 #ifndef CHATTERINO_TEST
-    scale *= getSettings()->emoteScale;
+    scale *= SettingsSnapshot::current()->emoteScale;
 #endif
 
     int quality = 1;
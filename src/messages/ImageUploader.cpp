@@ -0,0 +1,164 @@
+#include "messages/ImageUploader.hpp"
+
+#include "Application.hpp"
+#include "debug/AssertInGuiThread.hpp"
+#include "singletons/WindowManager.hpp"
+#include "util/DebugCount.hpp"
+#include "util/PostToThread.hpp"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+
+    // time spent converting frames per frame, leaves most of a 60 fps frame
+    // for layout and painting
+    constexpr auto uploadBudget = std::chrono::milliseconds(4);
+    constexpr auto frameInterval = std::chrono::milliseconds(16);
+
+    double millisecondsSince(ImageUploader::Clock::time_point time)
+    {
+        return std::chrono::duration<double, std::milli>(
+                   ImageUploader::Clock::now() - time)
+            .count();
+    }
+
+}  // namespace
+
+ImageUploader &ImageUploader::instance()
+{
+    static ImageUploader *instance = new ImageUploader();
+    return *instance;
+}
+
+ImageUploader::ImageUploader()
+{
+    // in case the first image is decoded before the application created us
+    this->timer_.moveToThread(QCoreApplication::instance()->thread());
+
+    this->timer_.setSingleShot(true);
+    QObject::connect(&this->timer_, &QTimer::timeout, &this->timer_, [this] {
+        this->upload();
+    });
+}
+
+void ImageUploader::push(QVector<detail::Frame<QImage>> frames, Assign assign)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->queue_.push_back(
+        Upload{std::move(frames), std::move(assign), Clock::now()});
+    DebugCount::increase("image uploads queued");
+
+    if (!this->scheduled_)
+    {
+        this->scheduled_ = true;
+
+        postToThread([this] {
+            this->schedule();
+        });
+    }
+}
+
+void ImageUploader::schedule()
+{
+    assertInGuiThread();
+
+    // don't upload more than once per frame
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+        this->lastUpload_ + frameInterval - Clock::now());
+
+    this->timer_.start(int(std::max<int64_t>(0, wait.count())));
+}
+
+void ImageUploader::upload()
+{
+    assertInGuiThread();
+
+    auto start = Clock::now();
+    this->lastUpload_ = start;
+
+    auto count = 0;
+
+    while (true)
+    {
+        Upload upload;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+
+            if (this->queue_.empty())
+            {
+                this->scheduled_ = false;
+                break;
+            }
+
+            // always upload at least one image so large ones can't get stuck
+            if (count > 0 && Clock::now() - start > uploadBudget)
+            {
+                this->deferred_ += this->queue_.size() - this->deferredInQueue_;
+                this->deferredInQueue_ = this->queue_.size();
+                this->timer_.start(
+                    int(std::chrono::milliseconds(frameInterval).count()));
+                break;
+            }
+
+            upload = std::move(this->queue_.front());
+            this->queue_.pop_front();
+
+            if (this->deferredInQueue_ > 0)
+            {
+                this->deferredInQueue_--;
+            }
+        }
+
+        DebugCount::decrease("image uploads queued");
+
+        auto frames = QVector<detail::Frame<QPixmap>>();
+        frames.reserve(upload.frames.size());
+        std::transform(upload.frames.begin(), upload.frames.end(),
+                       std::back_inserter(frames), [](auto &frame) {
+                           return detail::Frame<QPixmap>{
+                               QPixmap::fromImage(frame.image),
+                               frame.duration};
+                       });
+
+        upload.assign(frames);
+
+        this->latencyMs_.add(millisecondsSince(upload.queuedAt));
+        this->uploaded_++;
+        count++;
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    this->stageMs_.add(millisecondsSince(start));
+
+#ifndef CHATTERINO_TEST
+    // only the layouts that are waiting for one of these images will be
+    // laid out again
+    getApp()->windows->layoutChannelViews();
+#endif
+}
+
+QString ImageUploader::getDebugText() const
+{
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        queued = this->queue_.size();
+    }
+
+    return QString("image uploads: %1 waiting, %2 uploaded, %3 deferred\n")
+               .arg(queued)
+               .arg(this->uploaded_)
+               .arg(this->deferred_) +
+           this->latencyMs_.getDebugText("upload latency ms") +
+           this->stageMs_.getDebugText("upload stage ms");
+}
+
+}  // namespace chatterino
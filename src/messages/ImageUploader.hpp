@@ -0,0 +1,71 @@
+#pragma once
+
+#include "debug/FrameStats.hpp"
+#include "messages/Image.hpp"
+
+#include <QImage>
+#include <QPixmap>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace chatterino {
+
+/// Turns decoded frames into pixmaps and hands them to their image on the gui
+/// thread. Uploads are done at most once per frame and only for a few
+/// milliseconds, the rest waits for the next frame. Channel views are asked
+/// to lay out once per frame, which only lays out the messages waiting for
+/// one of the images.
+class ImageUploader : boost::noncopyable
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Assign = std::function<void(const QVector<detail::Frame<QPixmap>> &)>;
+
+    static ImageUploader &instance();
+
+    // Queues `frames` to be converted and passed to `assign` on the gui
+    // thread. Can be called from any thread.
+    void push(QVector<detail::Frame<QImage>> frames, Assign assign);
+
+    QString getDebugText() const;
+
+private:
+    ImageUploader();
+
+    // gui thread
+    void schedule();
+    void upload();
+
+    struct Upload {
+        QVector<detail::Frame<QImage>> frames;
+        Assign assign;
+        Clock::time_point queuedAt;
+    };
+
+    mutable std::mutex mutex_;
+    std::deque<Upload> queue_;
+    // the uploads at the front of the queue that were already counted as
+    // deferred
+    size_t deferredInQueue_ = 0;
+    // true while an upload is posted or the timer is running
+    bool scheduled_ = false;
+
+    Clock::time_point lastUpload_{};
+    QTimer timer_;
+
+    uint64_t uploaded_ = 0;
+    // uploads that had to wait for a later frame, each counted once
+    uint64_t deferred_ = 0;
+    RollingHistogram latencyMs_;
+    RollingHistogram stageMs_;
+};
+
+}  // namespace chatterino
@@ -228,6 +228,11 @@ public:
         return this->limit_ - this->space() == 0;
     }
 
+    size_t limit() const
+    {
+        return this->limit_;
+    }
+
 private:
     qsizetype space() const
     {
@@ -33,4 +33,16 @@ const QColor &MessageColor::getColor(Theme &themeManager) const
     return _default;
 }
 
+const QColor &MessageColor::getNormalizedColor(Theme &themeManager) const
+{
+    if (this->normalizedGeneration_ != themeManager.getGeneration())
+    {
+        this->normalizedColor_ =
+            themeManager.getNormalizedColor(this->getColor(themeManager));
+        this->normalizedGeneration_ = themeManager.getGeneration();
+    }
+
+    return this->normalizedColor_;
+}
+
 }  // namespace chatterino
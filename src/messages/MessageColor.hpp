@@ -13,9 +13,16 @@ struct MessageColor {
 
     const QColor &getColor(Theme &themeManager) const;
 
+    // Returns the color normalized for the current theme. The result is kept
+    // until the theme changes, copies of this color share it until then.
+    const QColor &getNormalizedColor(Theme &themeManager) const;
+
 private:
     Type type_;
     QColor customColor_;
+
+    mutable QColor normalizedColor_;
+    mutable int normalizedGeneration_ = -1;
 };
 
 }  // namespace chatterino
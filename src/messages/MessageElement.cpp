@@ -6,7 +6,7 @@
 #include "messages/Emote.hpp"
 #include "messages/layouts/MessageLayoutContainer.hpp"
 #include "messages/layouts/MessageLayoutElement.hpp"
-#include "singletons/Settings.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 #include "singletons/Theme.hpp"
 #include "util/DebugCount.hpp"
 
@@ -136,6 +136,7 @@ void ImageElement::addToContainer(MessageLayoutContainer &container,
         auto size = QSize(this->image_->width() * container.getScale(),
                           this->image_->height() * container.getScale());
 
+        container.addPendingImage(this->image_);
         container.addElement((new ImageLayoutElement(*this, this->image_, size))
                                  ->setLink(this->getLink()));
     }
@@ -169,7 +170,11 @@ void EmoteElement::addToContainer(MessageLayoutContainer &container,
             if (image->isEmpty())
                 return;
 
-            auto emoteScale = getSettings()->emoteScale.getValue();
+            // a loaded fallback might be shown until the right size is loaded
+            container.addPendingImage(
+                this->emote_->images.getImage(container.getScale()));
+
+            auto emoteScale = container.getSettingsSnapshot().emoteScale;
 
             auto size =
                 QSize(int(container.getScale() * image->width() * emoteScale),
@@ -213,6 +218,9 @@ void BadgeElement::addToContainer(MessageLayoutContainer &container,
         if (image->isEmpty())
             return;
 
+        container.addPendingImage(
+            this->emote_->images.getImage(container.getScale()));
+
         auto size = QSize(int(container.getScale() * image->width()),
                           int(container.getScale() * image->height()));
 
@@ -293,14 +301,30 @@ TextElement::TextElement(const QString &text, MessageElementFlags flags,
     : MessageElement(flags)
     , color_(color)
     , style_(style)
+    , content_(text)
 {
-    for (const auto &word : text.split(' '))
+    int start = 0;
+    while (true)
     {
-        this->words_.push_back({word, -1});
+        auto end = this->content_.indexOf(' ', start);
+        if (end == -1)
+        {
+            this->words_.push_back(
+                {start, this->content_.length() - start, -1});
+            break;
+        }
+
+        this->words_.push_back({start, end - start, -1});
+        start = end + 1;
         // fourtf: add logic to store multiple spaces after message
     }
 }
 
+QString TextElement::view(int offset, int length) const
+{
+    return QString::fromRawData(this->content_.constData() + offset, length);
+}
+
 void TextElement::addToContainer(MessageLayoutContainer &container,
                                  MessageElementFlags flags)
 {
@@ -311,19 +335,30 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
         QFontMetrics metrics =
             app->fonts->getFontMetrics(this->style_, container.getScale());
 
+        // the layout elements copy the color along with its normalized value,
+        // so it's only computed once per element and theme
+        this->color_.getNormalizedColor(*app->themes);
+
+        if (this->measuredScale_ != container.getScale() ||
+            this->measuredFontGeneration_ != app->fonts->getGeneration())
+        {
+            for (Word &word : this->words_)
+            {
+                word.width = -1;
+            }
+            this->measuredScale_ = container.getScale();
+            this->measuredFontGeneration_ = app->fonts->getGeneration();
+        }
+
         for (Word &word : this->words_)
         {
             auto getTextLayoutElement = [&](QString text, int width,
                                             bool hasTrailingSpace) {
-                auto color = this->color_.getColor(*app->themes);
-                app->themes->normalizeColor(color);
-
                 auto e = (new TextLayoutElement(
                               *this, text, QSize(width, metrics.height()),
-                              color, this->style_, container.getScale()))
+                              this->color_, this->style_, container.getScale()))
                              ->setLink(this->getLink());
                 e->setTrailingSpace(hasTrailingSpace);
-                e->setText(text);
 
                 // If URL link was changed,
                 // Should update it in MessageLayoutElement too!
@@ -334,16 +369,20 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
                 return e;
             };
 
-            // fourtf: add again
-            //            if (word.width == -1) {
-            word.width = metrics.horizontalAdvance(word.text);
-            //            }
+            // the text of the layout elements points into content_, words
+            // aren't copied
+            auto wordText = this->view(word.offset, word.length);
+
+            if (word.width == -1)
+            {
+                word.width = metrics.horizontalAdvance(wordText);
+            }
 
             // see if the text fits in the current line
             if (container.fitsInLine(word.width))
             {
                 container.addElementNoLineBreak(getTextLayoutElement(
-                    word.text, word.width, this->hasTrailingSpace()));
+                    wordText, word.width, this->hasTrailingSpace()));
                 continue;
             }
 
@@ -355,13 +394,13 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
                 if (container.fitsInLine(word.width))
                 {
                     container.addElementNoLineBreak(getTextLayoutElement(
-                        word.text, word.width, this->hasTrailingSpace()));
+                        wordText, word.width, this->hasTrailingSpace()));
                     continue;
                 }
             }
 
             // we done goofed, we need to wrap the text
-            QString text = word.text;
+            const QString &text = wordText;
             int textLength = text.length();
             int wordStart = 0;
             int width = 0;
@@ -373,14 +412,17 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
                 auto isSurrogate = text.size() > i + 1 &&
                                    QChar::isHighSurrogate(text[i].unicode());
 
-                auto charWidth = isSurrogate
-                                     ? metrics.horizontalAdvance(text.mid(i, 2))
-                                     : metrics.horizontalAdvance(text[i]);
+                auto charWidth =
+                    isSurrogate
+                        ? metrics.horizontalAdvance(
+                              this->view(word.offset + i, 2))
+                        : metrics.horizontalAdvance(text[i]);
 
                 if (!container.fitsInLine(width + charWidth))
                 {
                     container.addElementNoLineBreak(getTextLayoutElement(
-                        text.mid(wordStart, i - wordStart), width, false));
+                        this->view(word.offset + wordStart, i - wordStart),
+                        width, false));
                     container.breakLine();
 
                     wordStart = i;
@@ -398,7 +440,8 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
             }
             //add the final piece of wrapped text
             container.addElementNoLineBreak(getTextLayoutElement(
-                text.mid(wordStart), width, this->hasTrailingSpace()));
+                this->view(word.offset + wordStart, textLength - wordStart),
+                width, this->hasTrailingSpace()));
         }
     }
 }
@@ -407,8 +450,9 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
 TimestampElement::TimestampElement(QTime time)
     : MessageElement(MessageElementFlag::Timestamp)
     , time_(time)
-    , element_(this->formatTime(time))
+    , format_(SettingsSnapshot::current()->timestampFormat)
 {
+    this->element_.reset(this->formatTime(time));
     assert(this->element_ != nullptr);
 }
 
@@ -417,9 +461,11 @@ void TimestampElement::addToContainer(MessageLayoutContainer &container,
 {
     if (flags.hasAny(this->getFlags()))
     {
-        if (getSettings()->timestampFormat != this->format_)
+        auto &format = container.getSettingsSnapshot().timestampFormat;
+        if (format != this->format_)
         {
-            this->format_ = getSettings()->timestampFormat.getValue();
+            this->format_ = format;
+            this->previousElements_.push_back(std::move(this->element_));
             this->element_.reset(this->formatTime(this->time_));
         }
 
@@ -431,7 +477,7 @@ TextElement *TimestampElement::formatTime(const QTime &time)
 {
     static QLocale locale("en_US");
 
-    QString format = locale.toString(time, getSettings()->timestampFormat);
+    QString format = locale.toString(time, this->format_);
 
     return new TextElement(format, MessageElementFlag::Timestamp,
                            MessageColor::System, FontStyle::ChatMedium);
@@ -559,13 +605,22 @@ void IrcTextElement::addToContainer(MessageLayoutContainer &container,
 {
     auto app = getApp();
 
-    MessageColor defaultColorType = MessageColor::Text;
-    auto defaultColor = defaultColorType.getColor(*app->themes);
     if (flags.hasAny(this->getFlags()))
     {
         QFontMetrics metrics =
             app->fonts->getFontMetrics(this->style_, container.getScale());
 
+        if (this->measuredScale_ != container.getScale() ||
+            this->measuredFontGeneration_ != app->fonts->getGeneration())
+        {
+            for (auto &word : this->words_)
+            {
+                word.width = -1;
+            }
+            this->measuredScale_ = container.getScale();
+            this->measuredFontGeneration_ = app->fonts->getGeneration();
+        }
+
         for (auto &word : this->words_)
         {
             auto getTextLayoutElement = [&](QString text,
@@ -575,12 +630,11 @@ void IrcTextElement::addToContainer(MessageLayoutContainer &container,
 
                 for (const auto &segment : segments)
                 {
-                    QColor color = defaultColor;
+                    MessageColor color = MessageColor::Text;
                     if (segment.fg >= 0 && segment.fg <= 98)
                     {
-                        color = IRC_COLORS[segment.fg];
+                        color = MessageColor(IRC_COLORS[segment.fg]);
                     }
-                    app->themes->normalizeColor(color);
                     xd.emplace_back(PajSegment{segment.text, color});
                 }
 
@@ -600,10 +654,10 @@ void IrcTextElement::addToContainer(MessageLayoutContainer &container,
                 return e;
             };
 
-            // fourtf: add again
-            //            if (word.width == -1) {
-            word.width = metrics.horizontalAdvance(word.text);
-            //            }
+            if (word.width == -1)
+            {
+                word.width = metrics.horizontalAdvance(word.text);
+            }
 
             // see if the text fits in the current line
             if (container.fitsInLine(word.width))
@@ -748,6 +802,9 @@ void ScalingImageElement::addToContainer(MessageLayoutContainer &container,
         if (image->isEmpty())
             return;
 
+        container.addPendingImage(
+            this->images_.getImage(container.getScale()));
+
         auto size = QSize(image->width() * container.getScale(),
                           image->height() * container.getScale());
 
@@ -222,14 +222,25 @@ public:
                         MessageElementFlags flags) override;
 
 private:
+    // Returns a string that points into content_ instead of copying it.
+    QString view(int offset, int length) const;
+
     MessageColor color_;
     FontStyle style_;
 
+    // the text is stored once, words are ranges of it
+    const QString content_;
+
     struct Word {
-        QString text;
+        int offset;
+        int length;
         int width = -1;
     };
     std::vector<Word> words_;
+
+    // word widths are only valid for this scale and font generation
+    float measuredScale_ = -1;
+    int measuredFontGeneration_ = -1;
 };
 
 // contains emote data and will pick the emote based on :
@@ -318,6 +329,10 @@ public:
 private:
     QTime time_;
     std::unique_ptr<TextElement> element_;
+    // Elements of earlier formats. Cached layouts keep referencing them and
+    // the text they own until they are laid out again, so they are kept
+    // along with the message.
+    std::vector<std::unique_ptr<TextElement>> previousElements_;
     QString format_;
 };
 
@@ -360,6 +375,10 @@ private:
     };
 
     std::vector<Word> words_;
+
+    // word widths are only valid for this scale and font generation
+    float measuredScale_ = -1;
+    int measuredFontGeneration_ = -1;
 };
 
 // Forces a linebreak
@@ -73,6 +73,7 @@ SharedMessageBuilder::SharedMessageBuilder(
     , tags(this->ircMessage->tags())
     , originalMessage_(_ircMessage->content())
     , action_(_ircMessage->isAction())
+    , settings_(SettingsSnapshot::current())
 {
 }
 
@@ -85,6 +86,7 @@ SharedMessageBuilder::SharedMessageBuilder(
     , tags(this->ircMessage->tags())
     , originalMessage_(content)
     , action_(isAction)
+    , settings_(SettingsSnapshot::current())
 {
 }
 
@@ -137,7 +139,7 @@ bool SharedMessageBuilder::isIgnored() const
 
 void SharedMessageBuilder::parseUsernameColor()
 {
-    if (getSettings()->colorizeNicknames)
+    if (this->settings_->colorizeNicknames)
     {
         this->usernameColor_ = getRandomColor(this->ircMessage->nick());
     }
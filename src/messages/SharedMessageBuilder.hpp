@@ -3,6 +3,7 @@
 #include "common/Aliases.hpp"
 #include "common/Outcome.hpp"
 #include "messages/MessageColor.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 
 #include <IrcMessage>
 #include <QColor>
@@ -60,6 +61,10 @@ protected:
 
     const bool action_{};
 
+    // settings used while building, taken once so a message isn't built with
+    // a mix of old and new values
+    const SettingsSnapshotPtr settings_;
+
     QColor usernameColor_ = {153, 153, 153};
     MessageColor textColor_ = MessageColor::Text;
 
@@ -0,0 +1,205 @@
+#include "messages/layouts/ImageAtlas.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+#include "messages/Image.hpp"
+#include "util/DebugCount.hpp"
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+
+    constexpr int pageSize = 1024;
+    constexpr int maxPages = 4;
+    // larger images aren't worth the atlas space
+    constexpr int maxImageSize = 128;
+    constexpr int usesBeforePacking = 3;
+    // once there are this many slots we start over to get rid of dead images
+    constexpr size_t maxSlots = 8192;
+    // space between images so smooth scaling doesn't bleed into neighbours
+    constexpr int padding = 1;
+
+}  // namespace
+
+ImageAtlas &ImageAtlas::instance()
+{
+    static ImageAtlas *instance = new ImageAtlas();
+    return *instance;
+}
+
+boost::optional<ImageAtlas::Entry> ImageAtlas::lookup(const ImagePtr &image,
+                                                      const QSize &size)
+{
+    assertInGuiThread();
+
+    if (image == nullptr || image->isEmpty() || !image->loaded() ||
+        image->animated())
+    {
+        return boost::none;
+    }
+
+    // painting from the atlas doesn't go through pixmapOrLoad
+    image->markUsed();
+
+    if (size.width() <= 0 || size.height() <= 0 ||
+        size.width() > maxImageSize || size.height() > maxImageSize)
+    {
+        return boost::none;
+    }
+
+    auto &slot = this->slots_[Key{image.get(), size.width(), size.height()}];
+
+    // the address might belong to an image that was destroyed in the meantime
+    if (slot.image.lock() != image)
+    {
+        slot = Slot{image, boost::none, 0};
+    }
+
+    if (slot.entry)
+    {
+        return slot.entry;
+    }
+
+    if (++slot.uses < usesBeforePacking)
+    {
+        return boost::none;
+    }
+
+    slot.entry = this->pack(*image, size);
+
+    if (this->slots_.size() > maxSlots)
+    {
+        this->clearPending_ = true;
+    }
+
+    return slot.entry;
+}
+
+const QPixmap &ImageAtlas::page(int index) const
+{
+    return this->pages_.at(size_t(index));
+}
+
+void ImageAtlas::beginBatch()
+{
+    if (this->clearPending_)
+    {
+        this->clear();
+    }
+}
+
+boost::optional<ImageAtlas::Entry> ImageAtlas::pack(const Image &image,
+                                                    const QSize &size)
+{
+    auto pixmap = image.scaledPixmapOrLoad(size);
+    if (!pixmap)
+    {
+        return boost::none;
+    }
+
+    auto width = size.width() + padding;
+    auto height = size.height() + padding;
+
+    // start a new shelf
+    if (this->shelfX_ + width > pageSize)
+    {
+        this->shelfX_ = 0;
+        this->shelfY_ += this->shelfHeight_;
+        this->shelfHeight_ = 0;
+    }
+
+    // start a new page
+    if (this->pages_.empty() || this->shelfY_ + height > pageSize)
+    {
+        if (this->pages_.size() >= maxPages)
+        {
+            this->clearPending_ = true;
+            return boost::none;
+        }
+
+        QPixmap page(pageSize, pageSize);
+        page.fill(Qt::transparent);
+        this->pages_.push_back(page);
+        DebugCount::increase("image atlas pages");
+
+        this->shelfX_ = 0;
+        this->shelfY_ = 0;
+        this->shelfHeight_ = 0;
+    }
+
+    auto rect = QRect(this->shelfX_, this->shelfY_, size.width(),
+                      size.height());
+
+    QPainter painter(&this->pages_.back());
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(rect, *pixmap);
+
+    this->shelfX_ += width;
+    this->shelfHeight_ = std::max(this->shelfHeight_, height);
+
+    return Entry{int(this->pages_.size()) - 1, rect};
+}
+
+void ImageAtlas::clear()
+{
+    DebugCount::decrease("image atlas pages", int64_t(this->pages_.size()));
+
+    this->slots_.clear();
+    this->pages_.clear();
+    this->shelfX_ = 0;
+    this->shelfY_ = 0;
+    this->shelfHeight_ = 0;
+    this->clearPending_ = false;
+}
+
+//
+// BATCH
+//
+
+ImageAtlasBatch::ImageAtlasBatch()
+{
+    ImageAtlas::instance().beginBatch();
+}
+
+bool ImageAtlasBatch::add(const ImagePtr &image, const QRectF &target,
+                          qreal devicePixelRatio)
+{
+    auto entry = ImageAtlas::instance().lookup(
+        image, (target.size() * devicePixelRatio).toSize());
+
+    if (!entry)
+    {
+        return false;
+    }
+
+    if (this->fragments_.size() <= size_t(entry->page))
+    {
+        this->fragments_.resize(size_t(entry->page) + 1);
+    }
+
+    this->fragments_[size_t(entry->page)].push_back(
+        QPainter::PixmapFragment::create(
+            target.center(), QRectF(entry->source),
+            target.width() / entry->source.width(),
+            target.height() / entry->source.height()));
+
+    return true;
+}
+
+void ImageAtlasBatch::paint(QPainter &painter)
+{
+    auto &atlas = ImageAtlas::instance();
+
+    for (size_t i = 0; i < this->fragments_.size(); i++)
+    {
+        const auto &fragments = this->fragments_[i];
+
+        if (!fragments.empty())
+        {
+            painter.drawPixmapFragments(fragments.data(), int(fragments.size()),
+                                        atlas.page(int(i)));
+        }
+    }
+}
+
+}  // namespace chatterino
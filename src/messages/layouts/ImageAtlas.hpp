@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace chatterino {
+
+class Image;
+using ImagePtr = std::shared_ptr<Image>;
+
+/// Packs frequently painted static images (badges, emotes) at the size they
+/// are painted at into a few large pixmaps, so a message can draw all of its
+/// images with one drawPixmapFragments call per atlas page.
+///
+/// Gui thread only.
+class ImageAtlas : boost::noncopyable
+{
+public:
+    struct Entry {
+        int page;
+        QRect source;
+    };
+
+    static ImageAtlas &instance();
+
+    // Returns where `image` scaled to `size` (in device pixels) is stored.
+    // Images are only packed once they were looked up a few times, until then
+    // boost::none is returned and the image has to be painted on its own.
+    boost::optional<Entry> lookup(const ImagePtr &image, const QSize &size);
+    const QPixmap &page(int index) const;
+
+    // Called before a batch of lookups. Clears the atlas if it ran full
+    // during the previous batch. Pages are never removed during a batch, so
+    // page indices stay valid until the batch is painted.
+    void beginBatch();
+
+private:
+    ImageAtlas() = default;
+
+    struct Key {
+        const Image *image;
+        int width;
+        int height;
+
+        bool operator==(const Key &other) const
+        {
+            return this->image == other.image && this->width == other.width &&
+                   this->height == other.height;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const
+        {
+            return std::hash<const Image *>()(key.image) ^
+                   (size_t(key.width) << 16) ^ size_t(key.height);
+        }
+    };
+
+    struct Slot {
+        std::weak_ptr<Image> image;
+        boost::optional<Entry> entry;
+        int uses = 0;
+    };
+
+    boost::optional<Entry> pack(const Image &image, const QSize &size);
+    void clear();
+
+    std::unordered_map<Key, Slot, KeyHash> slots_;
+    std::vector<QPixmap> pages_;
+    bool clearPending_ = false;
+
+    // shelf packing state of the last page
+    int shelfX_ = 0;
+    int shelfY_ = 0;
+    int shelfHeight_ = 0;
+};
+
+/// Collects the atlas images of one message and draws them in as few calls as
+/// possible.
+class ImageAtlasBatch : boost::noncopyable
+{
+public:
+    ImageAtlasBatch();
+
+    // Adds `image` to be drawn into `target`. Returns false if the image is
+    // not in the atlas and has to be painted separately.
+    bool add(const ImagePtr &image, const QRectF &target,
+             qreal devicePixelRatio);
+    void paint(QPainter &painter);
+
+private:
+    // fragments to draw, indexed by atlas page
+    std::vector<std::vector<QPainter::PixmapFragment>> fragments_;
+};
+
+}  // namespace chatterino
@@ -4,9 +4,12 @@
 #include "debug/Benchmark.hpp"
 #include "messages/Message.hpp"
 #include "messages/MessageElement.hpp"
+#include "messages/layouts/MessageLayoutCache.hpp"
 #include "messages/layouts/MessageLayoutContainer.hpp"
 #include "singletons/Emotes.hpp"
+#include "singletons/Fonts.hpp"
 #include "singletons/Settings.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 #include "singletons/Theme.hpp"
 #include "singletons/WindowManager.hpp"
 #include "util/DebugCount.hpp"
@@ -22,6 +25,7 @@
 #define MARGIN_TOP (int)(4 * this->scale)
 #define MARGIN_BOTTOM (int)(4 * this->scale)
 #define COMPACT_EMOTES_OFFSET 6
+#define PROMOTE_TO_BUFFER_FRAMES 3
 
 namespace chatterino {
 
@@ -61,6 +65,11 @@ int MessageLayout::getHeight() const
     return container_->getHeight();
 }
 
+unsigned int MessageLayout::getLayoutCount() const
+{
+    return this->layoutCount_;
+}
+
 // Layout
 // return true if redraw is required
 bool MessageLayout::layout(int width, float scale, MessageElementFlags flags)
@@ -84,6 +93,10 @@ bool MessageLayout::layout(int width, float scale, MessageElementFlags flags)
         this->layoutState_ = app->windows->getGeneration();
     }
 
+    // check if fonts changed
+    layoutRequired |= this->fontState_ != app->fonts->getGeneration();
+    this->fontState_ = app->fonts->getGeneration();
+
     // check if work mask changed
     layoutRequired |= this->currentWordFlags_ != flags;
     this->currentWordFlags_ = flags;  // getSettings()->getWordTypeMask();
@@ -96,8 +109,22 @@ bool MessageLayout::layout(int width, float scale, MessageElementFlags flags)
     layoutRequired |= this->scale_ != scale;
     this->scale_ = scale;
 
+    // check if an image we're waiting for was loaded
+    layoutRequired |= this->container_->pendingImagesChanged();
+
+    // check if only the buffer has to be repainted, e.g. after theme changes
+    bool bufferOutdated =
+        this->bufferState_ != app->windows->getBufferGeneration();
+    this->bufferState_ = app->windows->getBufferGeneration();
+
     if (!layoutRequired)
     {
+        if (bufferOutdated)
+        {
+            this->invalidateBuffer();
+            return true;
+        }
+
         return false;
     }
 
@@ -124,37 +151,57 @@ void MessageLayout::actuallyLayout(int width, MessageElementFlags flags)
         messageFlags.unset(MessageFlag::Collapsed);
     }
 
-    this->container_->begin(width, this->scale_, messageFlags);
-
-    for (const auto &element : this->message_->elements)
+    auto app = getApp();
+    auto &cache = MessageLayoutCache::instance();
+    auto settings = SettingsSnapshot::current();
+
+    MessageLayoutCache::Key key{
+        this->message_.get(),
+        width,
+        this->scale_,
+        static_cast<int64_t>(flags.value()),
+        static_cast<uint32_t>(messageFlags.value()),
+        app->windows->getGeneration(),
+        app->fonts->getGeneration(),
+        settings->version,
+    };
+
+    // another view might have laid out this message the same way already
+    auto container = cache.find(key, this->message_);
+
+    if (container == nullptr || container->pendingImagesChanged())
     {
-        if (getSettings()->hideModerated &&
-            this->message_->flags.has(MessageFlag::Disabled))
-        {
-            continue;
-        }
-
-        if (getSettings()->hideModerationActions &&
-            this->message_->flags.has(MessageFlag::Timeout))
-        {
-            continue;
-        }
+        container = std::make_shared<MessageLayoutContainer>();
+        container->begin(width, this->scale_, messageFlags, settings);
 
-        if (getSettings()->hideSimilar &&
-            this->message_->flags.has(MessageFlag::Similar))
+        for (const auto &element : this->message_->elements)
         {
-            continue;
+            if (settings->hideModerated &&
+                this->message_->flags.has(MessageFlag::Disabled))
+            {
+                continue;
+            }
+
+            if (settings->hideModerationActions &&
+                this->message_->flags.has(MessageFlag::Timeout))
+            {
+                continue;
+            }
+
+            if (settings->hideSimilar &&
+                this->message_->flags.has(MessageFlag::Similar))
+            {
+                continue;
+            }
+
+            element->addToContainer(*container, flags);
         }
 
-        element->addToContainer(*this->container_, flags);
+        container->end();
+        cache.insert(key, this->message_, container);
     }
 
-    if (this->height_ != this->container_->getHeight())
-    {
-        this->deleteBuffer();
-    }
-
-    this->container_->end();
+    this->container_ = container;
     this->height_ = this->container_->getHeight();
 
     // collapsed state
@@ -166,38 +213,68 @@ void MessageLayout::actuallyLayout(int width, MessageElementFlags flags)
 }
 
 // Painting
-void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
+bool MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
                           Selection &selection, bool isLastReadMessage,
-                          bool isWindowFocused, bool isMentions)
+                          bool isWindowFocused, bool isMentions,
+                          const SettingsSnapshot &settings, uint64_t frame)
 {
     auto app = getApp();
     QPixmap *pixmap = this->buffer_.get();
+    bool elementsPainted = false;
 
-    // create new buffer if required
-    if (!pixmap)
+    // most messages are only on screen for a few frames while scrolling fast
+    // or in floods, those are drawn directly instead of through a buffer
+    if (!pixmap && settings.lazyMessageBuffers &&
+        this->visibleFrames_ < PROMOTE_TO_BUFFER_FRAMES)
     {
+        if (frame != this->lastVisibleFrame_)
+        {
+            this->lastVisibleFrame_ = frame;
+            this->visibleFrames_++;
+        }
+        this->paintDirect(painter, width, y, settings);
+        elementsPainted = true;
+    }
+    else
+    {
+        // create new buffer if required
+        if (!pixmap)
+        {
 #if defined(Q_OS_MACOS) || defined(Q_OS_LINUX)
-        pixmap = new QPixmap(int(width * painter.device()->devicePixelRatioF()),
-                             int(container_->getHeight() *
-                                 painter.device()->devicePixelRatioF()));
-        pixmap->setDevicePixelRatio(painter.device()->devicePixelRatioF());
+            pixmap = new QPixmap(
+                int(width * painter.device()->devicePixelRatioF()),
+                int(container_->getHeight() *
+                    painter.device()->devicePixelRatioF()));
+            pixmap->setDevicePixelRatio(painter.device()->devicePixelRatioF());
 #else
-        pixmap =
-            new QPixmap(width, std::max(16, this->container_->getHeight()));
+            pixmap =
+                new QPixmap(width, std::max(16, this->container_->getHeight()));
 #endif
 
-        this->buffer_ = std::shared_ptr<QPixmap>(pixmap);
-        this->bufferValid_ = false;
-        DebugCount::increase("message drawing buffers");
-    }
+            this->buffer_ = std::shared_ptr<QPixmap>(pixmap);
+            this->bufferValid_ = false;
+            DebugCount::increase("message drawing buffers");
+        }
 
-    if (!this->bufferValid_ || !selection.isEmpty())
-    {
-        this->updateBuffer(pixmap, messageIndex, selection);
+        if (!this->bufferValid_ || !selection.isEmpty())
+        {
+            this->updateBuffer(pixmap, messageIndex, selection, settings);
+            elementsPainted = true;
+        }
+
+        // draw on buffer
+        painter.drawPixmap(0, y, *pixmap);
+
+        if (!elementsPainted)
+        {
+            this->container_->markImagesUsed();
+        }
     }
 
-    // draw on buffer
-    painter.drawPixmap(0, y, *pixmap);
+    auto overlayWidth = pixmap ? pixmap->width() : width;
+    auto overlayHeight =
+        pixmap ? pixmap->height() : this->container_->getHeight();
+
     //    painter.drawPixmap(0, y, this->container.width,
     //    this->container.getHeight(), *pixmap);
 
@@ -207,7 +284,7 @@ void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
     // draw disabled
     if (this->message_->flags.has(MessageFlag::Disabled))
     {
-        painter.fillRect(0, y, pixmap->width(), pixmap->height(),
+        painter.fillRect(0, y, overlayWidth, overlayHeight,
                          app->themes->messages.disabled);
         //        painter.fillRect(0, y, pixmap->width(), pixmap->height(),
         //                         QBrush(QColor(64, 64, 64, 64)));
@@ -215,17 +292,17 @@ void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
 
     if (this->message_->flags.has(MessageFlag::RecentMessage))
     {
-        painter.fillRect(0, y, pixmap->width(), pixmap->height(),
+        painter.fillRect(0, y, overlayWidth, overlayHeight,
                          app->themes->messages.disabled);
     }
 
     if (!isMentions &&
         (this->message_->flags.has(MessageFlag::RedeemedChannelPointReward) ||
          this->message_->flags.has(MessageFlag::RedeemedHighlight)) &&
-        getSettings()->enableRedeemedHighlight.getValue())
+        settings.enableRedeemedHighlight)
     {
         painter.fillRect(
-            0, y, this->scale_ * 4, pixmap->height(),
+            0, y, this->scale_ * 4, overlayHeight,
             *ColorProvider::instance().color(ColorType::RedeemedHighlight));
     }
 
@@ -236,7 +313,7 @@ void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
     }
 
     // draw message seperation line
-    if (getSettings()->separateMessages.getValue())
+    if (settings.separateMessages)
     {
         painter.fillRect(0, y, this->container_->getWidth() + 64, 1,
                          app->themes->splits.messageSeperator);
@@ -246,9 +323,9 @@ void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
     if (isLastReadMessage)
     {
         QColor color;
-        if (getSettings()->lastMessageColor != "")
+        if (settings.lastMessageColor != "")
         {
-            color = QColor(getSettings()->lastMessageColor.getValue());
+            color = QColor(settings.lastMessageColor);
         }
         else
         {
@@ -258,31 +335,70 @@ void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
                     : app->themes->tabs.selected.backgrounds.unfocused.color();
         }
 
-        QBrush brush(color, static_cast<Qt::BrushStyle>(
-                                getSettings()->lastMessagePattern.getValue()));
+        QBrush brush(color, settings.lastMessagePattern);
 
         painter.fillRect(0, y + this->container_->getHeight() - 1,
-                         pixmap->width(), 1, brush);
+                         overlayWidth, 1, brush);
     }
 
     this->bufferValid_ = true;
+
+    return elementsPainted;
 }
 
 void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
-                                 Selection & /*selection*/)
+                                 Selection & /*selection*/,
+                                 const SettingsSnapshot &settings)
 {
     if (buffer->isNull())
         return;
 
-    auto app = getApp();
-    auto settings = getSettings();
-
     QPainter painter(buffer);
     painter.setRenderHint(QPainter::SmoothPixmapTransform);
 
     // draw background
-    QColor backgroundColor = [this, &app] {
-        if (getSettings()->alternateMessages.getValue() &&
+    painter.fillRect(buffer->rect(), this->getBackgroundColor(settings));
+
+    // draw message
+    this->container_->paintElements(painter);
+
+#ifdef FOURTF
+    // debug
+    painter.setPen(QColor(255, 0, 0));
+    painter.drawRect(buffer->rect().x(), buffer->rect().y(),
+                     buffer->rect().width() - 1, buffer->rect().height() - 1);
+
+    QTextOption option;
+    option.setAlignment(Qt::AlignRight | Qt::AlignTop);
+
+    painter.drawText(QRectF(1, 1, this->container_->getWidth() - 3, 1000),
+                     QString::number(this->layoutCount_) + ", " +
+                         QString::number(++this->bufferUpdatedCount_),
+                     option);
+#endif
+}
+
+void MessageLayout::paintDirect(QPainter &painter, int width, int y,
+                                const SettingsSnapshot &settings)
+{
+    painter.save();
+    painter.translate(0, y);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    painter.fillRect(QRect(0, 0, width, this->container_->getHeight()),
+                     this->getBackgroundColor(settings));
+    this->container_->paintElements(painter);
+
+    painter.restore();
+}
+
+QColor MessageLayout::getBackgroundColor(
+    const SettingsSnapshot &settings) const
+{
+    auto app = getApp();
+
+    QColor backgroundColor = [this, &app, &settings] {
+        if (settings.alternateMessages &&
             this->flags.has(MessageLayoutFlag::AlternateBackground))
         {
             return app->themes->messages.backgrounds.alternate;
@@ -302,7 +418,7 @@ void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
             blendColors(backgroundColor, *this->message_->highlightColor);
     }
     else if (this->message_->flags.has(MessageFlag::Subscription) &&
-             getSettings()->enableSubHighlight)
+             settings.enableSubHighlight)
     {
         // Blend highlight color with usual background color
         backgroundColor = blendColors(
@@ -312,7 +428,7 @@ void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
     else if ((this->message_->flags.has(MessageFlag::RedeemedHighlight) ||
               this->message_->flags.has(
                   MessageFlag::RedeemedChannelPointReward)) &&
-             settings->enableRedeemedHighlight.getValue())
+             settings.enableRedeemedHighlight)
     {
         // Blend highlight color with usual background color
         backgroundColor = blendColors(
@@ -328,25 +444,7 @@ void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
         backgroundColor = QColor("#4A273D");
     }
 
-    painter.fillRect(buffer->rect(), backgroundColor);
-
-    // draw message
-    this->container_->paintElements(painter);
-
-#ifdef FOURTF
-    // debug
-    painter.setPen(QColor(255, 0, 0));
-    painter.drawRect(buffer->rect().x(), buffer->rect().y(),
-                     buffer->rect().width() - 1, buffer->rect().height() - 1);
-
-    QTextOption option;
-    option.setAlignment(Qt::AlignRight | Qt::AlignTop);
-
-    painter.drawText(QRectF(1, 1, this->container_->getWidth() - 3, 1000),
-                     QString::number(this->layoutCount_) + ", " +
-                         QString::number(++this->bufferUpdatedCount_),
-                     option);
-#endif
+    return backgroundColor;
 }
 
 void MessageLayout::invalidateBuffer()
@@ -356,6 +454,8 @@ void MessageLayout::invalidateBuffer()
 
 void MessageLayout::deleteBuffer()
 {
+    this->visibleFrames_ = 0;
+
     if (this->buffer_ != nullptr)
     {
         DebugCount::decrease("message drawing buffers");
@@ -368,9 +468,12 @@ void MessageLayout::deleteCache()
 {
     this->deleteBuffer();
 
-#ifdef XD
-    this->container_->clear();
-#endif
+    // the container might be shared with other views
+    this->container_ = std::make_shared<MessageLayoutContainer>();
+    this->height_ = 0;
+
+    // lay out again the next time the message is needed
+    this->currentLayoutWidth_ = -1;
 }
 
 // Elements
@@ -14,6 +14,7 @@ struct Message;
 using MessagePtr = std::shared_ptr<const Message>;
 
 struct Selection;
+struct SettingsSnapshot;
 struct MessageLayoutContainer;
 class MessageLayoutElement;
 
@@ -39,15 +40,22 @@ public:
     const Message *getMessage();
 
     int getHeight() const;
+    // number of times the elements were laid out, layout() also returns true
+    // when only the buffer was invalidated
+    unsigned int getLayoutCount() const;
 
     MessageLayoutFlags flags;
 
     bool layout(int width, float scale_, MessageElementFlags flags);
 
     // Painting
-    void paint(QPainter &painter, int width, int y, int messageIndex,
+    // Returns true if the message elements had to be drawn, either into the
+    // buffer or directly. `frame` is the frame counter of the view, paints
+    // within the same frame count once towards getting a buffer.
+    bool paint(QPainter &painter, int width, int y, int messageIndex,
                Selection &selection, bool isLastReadMessage,
-               bool isWindowFocused, bool isMentions);
+               bool isWindowFocused, bool isMentions,
+               const SettingsSnapshot &settings, uint64_t frame);
     void invalidateBuffer();
     void deleteBuffer();
     void deleteCache();
@@ -74,9 +82,15 @@ private:
 
     int currentLayoutWidth_ = -1;
     int layoutState_ = -1;
+    int bufferState_ = -1;
+    int fontState_ = -1;
     float scale_ = -1;
     unsigned int layoutCount_ = 0;
     unsigned int bufferUpdatedCount_ = 0;
+    // number of frames since the message came on screen, messages only get a
+    // buffer once they stayed on screen for a few frames
+    int visibleFrames_ = 0;
+    uint64_t lastVisibleFrame_ = 0;
 
     MessageElementFlags currentWordFlags_;
 
@@ -84,7 +98,11 @@ private:
 
     // methods
     void actuallyLayout(int width, MessageElementFlags flags);
-    void updateBuffer(QPixmap *pixmap, int messageIndex, Selection &selection);
+    void updateBuffer(QPixmap *pixmap, int messageIndex, Selection &selection,
+                      const SettingsSnapshot &settings);
+    void paintDirect(QPainter &painter, int width, int y,
+                     const SettingsSnapshot &settings);
+    QColor getBackgroundColor(const SettingsSnapshot &settings) const;
 };
 
 using MessageLayoutPtr = std::shared_ptr<MessageLayout>;
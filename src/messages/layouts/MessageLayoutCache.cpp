@@ -0,0 +1,104 @@
+#include "messages/layouts/MessageLayoutCache.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+#include "messages/layouts/MessageLayoutContainer.hpp"
+
+#include <functional>
+
+namespace chatterino {
+namespace {
+
+    // expired entries are removed after this many insertions
+    constexpr size_t cleanupInterval = 1024;
+
+    void hashCombine(size_t &seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+}  // namespace
+
+bool MessageLayoutCache::Key::operator==(const Key &other) const
+{
+    return this->message == other.message && this->width == other.width &&
+           this->scale == other.scale &&
+           this->elementFlags == other.elementFlags &&
+           this->messageFlags == other.messageFlags &&
+           this->layoutGeneration == other.layoutGeneration &&
+           this->fontGeneration == other.fontGeneration &&
+           this->settingsVersion == other.settingsVersion;
+}
+
+size_t MessageLayoutCache::KeyHash::operator()(const Key &key) const
+{
+    size_t seed = std::hash<const Message *>()(key.message);
+    hashCombine(seed, std::hash<int>()(key.width));
+    hashCombine(seed, std::hash<float>()(key.scale));
+    hashCombine(seed, std::hash<int64_t>()(key.elementFlags));
+    hashCombine(seed, std::hash<uint32_t>()(key.messageFlags));
+    hashCombine(seed, std::hash<int>()(key.layoutGeneration));
+    hashCombine(seed, std::hash<int>()(key.fontGeneration));
+    hashCombine(seed, std::hash<int>()(key.settingsVersion));
+    return seed;
+}
+
+MessageLayoutCache &MessageLayoutCache::instance()
+{
+    static MessageLayoutCache *instance = new MessageLayoutCache();
+    return *instance;
+}
+
+std::shared_ptr<MessageLayoutContainer> MessageLayoutCache::find(
+    const Key &key, const MessagePtr &message)
+{
+    assertInGuiThread();
+
+    auto it = this->entries_.find(key);
+    if (it == this->entries_.end())
+    {
+        return nullptr;
+    }
+
+    // the address might belong to a message that was destroyed in the
+    // meantime
+    if (it->second.message.lock() != message)
+    {
+        this->entries_.erase(it);
+        return nullptr;
+    }
+
+    return it->second.container.lock();
+}
+
+void MessageLayoutCache::insert(
+    const Key &key, const MessagePtr &message,
+    std::shared_ptr<MessageLayoutContainer> container)
+{
+    assertInGuiThread();
+
+    this->entries_[key] = Entry{message, container};
+
+    if (++this->insertsSinceCleanup_ >= cleanupInterval)
+    {
+        this->removeExpired();
+    }
+}
+
+void MessageLayoutCache::removeExpired()
+{
+    for (auto it = this->entries_.begin(); it != this->entries_.end();)
+    {
+        if (it->second.container.expired() || it->second.message.expired())
+        {
+            it = this->entries_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    this->insertsSinceCleanup_ = 0;
+}
+
+}  // namespace chatterino
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace chatterino {
+
+struct Message;
+using MessagePtr = std::shared_ptr<const Message>;
+struct MessageLayoutContainer;
+
+/// Shares laid out messages between views that show the same message with the
+/// same parameters, e.g. several splits of the same channel.
+///
+/// Containers are never modified after they were laid out. Per view state like
+/// the selection, the alternating background and the buffer stays in the
+/// MessageLayout.
+///
+/// Gui thread only.
+class MessageLayoutCache : boost::noncopyable
+{
+public:
+    struct Key {
+        const Message *message;
+        int width;
+        float scale;
+        int64_t elementFlags;
+        uint32_t messageFlags;
+        int layoutGeneration;
+        int fontGeneration;
+        int settingsVersion;
+
+        bool operator==(const Key &other) const;
+    };
+
+    static MessageLayoutCache &instance();
+
+    // Returns the container laid out for `key`, or nullptr if no view holds
+    // one anymore.
+    std::shared_ptr<MessageLayoutContainer> find(const Key &key,
+                                                 const MessagePtr &message);
+    void insert(const Key &key, const MessagePtr &message,
+                std::shared_ptr<MessageLayoutContainer> container);
+
+private:
+    MessageLayoutCache() = default;
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Entry {
+        std::weak_ptr<const Message> message;
+        std::weak_ptr<MessageLayoutContainer> container;
+    };
+
+    void removeExpired();
+
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+    size_t insertsSinceCleanup_ = 0;
+};
+
+}  // namespace chatterino
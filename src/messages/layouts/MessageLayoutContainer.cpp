@@ -1,20 +1,25 @@
 #include "MessageLayoutContainer.hpp"
 
 #include "Application.hpp"
+#include "messages/Image.hpp"
 #include "messages/Message.hpp"
 #include "messages/MessageElement.hpp"
 #include "messages/Selection.hpp"
+#include "messages/layouts/ImageAtlas.hpp"
 #include "messages/layouts/MessageLayoutElement.hpp"
 #include "singletons/Fonts.hpp"
 #include "singletons/Settings.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 #include "singletons/Theme.hpp"
 
 #include <QDebug>
 #include <QPainter>
 
+#include <algorithm>
+#include <limits>
+
 #define COMPACT_EMOTES_OFFSET 4
-#define MAX_UNCOLLAPSED_LINES \
-    (getSettings()->collpseMessagesMinLines.getValue())
+#define MAX_UNCOLLAPSED_LINES (this->settings_->collapseMessagesMinLines)
 
 namespace chatterino {
 
@@ -33,13 +38,20 @@ float MessageLayoutContainer::getScale() const
     return this->scale_;
 }
 
+const SettingsSnapshot &MessageLayoutContainer::getSettingsSnapshot() const
+{
+    return *this->settings_;
+}
+
 // methods
-void MessageLayoutContainer::begin(int width, float scale, MessageFlags flags)
+void MessageLayoutContainer::begin(int width, float scale, MessageFlags flags,
+                                   SettingsSnapshotPtr settings)
 {
     this->clear();
     this->width_ = width;
     this->scale_ = scale;
     this->flags_ = flags;
+    this->settings_ = std::move(settings);
     auto mediumFontMetrics =
         getApp()->fonts->getFontMetrics(FontStyle::ChatMedium, scale);
     this->textLineHeight_ = mediumFontMetrics.height();
@@ -53,6 +65,8 @@ void MessageLayoutContainer::clear()
 {
     this->elements_.clear();
     this->lines_.clear();
+    this->elementBounds_.clear();
+    this->pendingImages_.clear();
 
     this->height_ = 0;
     this->line_ = 0;
@@ -134,7 +148,7 @@ void MessageLayoutContainer::_addElement(MessageLayoutElement *element,
 
     // compact emote offset
     bool isCompactEmote =
-        getSettings()->compactEmotes &&
+        this->settings_->compactEmotes &&
         !this->flags_.has(MessageFlag::DisableCompactEmotes) &&
         element->getCreator().getFlags().has(MessageElementFlag::EmoteImages);
 
@@ -164,7 +178,7 @@ void MessageLayoutContainer::_addElement(MessageLayoutElement *element,
         yOffset -= (this->margin.top * this->scale_);
     }
 
-    if (getSettings()->removeSpacesBetweenEmotes &&
+    if (this->settings_->removeSpacesBetweenEmotes &&
         element->getFlags().hasAny({MessageElementFlag::EmoteImages}) &&
         shouldRemoveSpaceBetweenEmotes())
     {
@@ -215,7 +229,7 @@ void MessageLayoutContainer::breakLine()
         MessageLayoutElement *element = this->elements_.at(i).get();
 
         bool isCompactEmote =
-            getSettings()->compactEmotes &&
+            this->settings_->compactEmotes &&
             !this->flags_.has(MessageFlag::DisableCompactEmotes) &&
             element->getCreator().getFlags().has(
                 MessageElementFlag::EmoteImages);
@@ -317,11 +331,64 @@ void MessageLayoutContainer::end()
         this->lines_.back().endIndex = this->elements_.size();
         this->lines_.back().endCharIndex = this->charIndex_;
     }
+
+    this->buildIndex();
+}
+
+void MessageLayoutContainer::buildIndex()
+{
+    this->elementBounds_.resize(this->elements_.size());
+
+    for (auto &line : this->lines_)
+    {
+        int maxRight = std::numeric_limits<int>::min();
+        int maxSelectionRight = std::numeric_limits<int>::min();
+        int charIndex = line.startCharIndex;
+
+        for (int i = line.startIndex; i < line.endIndex; i++)
+        {
+            auto &element = this->elements_[i];
+            auto &bounds = this->elementBounds_[i];
+            auto rightMargin =
+                element->hasTrailingSpace() ? this->spaceWidth_ : 0;
+
+            maxRight = std::max(maxRight, element->getRect().right());
+            maxSelectionRight = std::max(
+                maxSelectionRight, element->getRect().right() + rightMargin);
+
+            bounds.maxRight = maxRight;
+            bounds.maxSelectionRight = maxSelectionRight;
+            bounds.charIndex = charIndex;
+
+            charIndex += element->getSelectionIndexCount();
+        }
+
+        int minLeft = std::numeric_limits<int>::max();
+
+        for (int i = line.endIndex - 1; i >= line.startIndex; i--)
+        {
+            minLeft = std::min(minLeft, this->elements_[i]->getRect().left());
+            this->elementBounds_[i].minLeft = minLeft;
+        }
+    }
+}
+
+size_t MessageLayoutContainer::lineAt(int y) const
+{
+    // lines are stacked without gaps, so the first one that ends below `y`
+    // contains it
+    auto it = std::lower_bound(this->lines_.begin(), this->lines_.end(), y,
+                               [](const Line &line, int y) {
+                                   return line.rect.bottom() < y;
+                               });
+
+    return std::min(size_t(it - this->lines_.begin()),
+                    this->lines_.size() - 1);
 }
 
 bool MessageLayoutContainer::canCollapse()
 {
-    return getSettings()->collpseMessagesMinLines.getValue() > 0 &&
+    return this->settings_->collapseMessagesMinLines > 0 &&
            this->flags_.has(MessageFlag::Collapsed);
 }
 
@@ -330,10 +397,67 @@ bool MessageLayoutContainer::isCollapsed()
     return this->isCollapsed_;
 }
 
+void MessageLayoutContainer::addPendingImage(const ImagePtr &image)
+{
+    if (image && !image->isEmpty() && !image->loaded())
+    {
+        this->pendingImages_.push_back(image);
+    }
+}
+
+bool MessageLayoutContainer::pendingImagesChanged() const
+{
+    return std::any_of(this->pendingImages_.begin(), this->pendingImages_.end(),
+                       [](const ImagePtr &image) {
+                           return image->isEmpty() || image->loaded();
+                       });
+}
+
 MessageLayoutElement *MessageLayoutContainer::getElementAt(QPoint point)
 {
-    for (std::unique_ptr<MessageLayoutElement> &element : this->elements_)
+    if (this->lines_.empty())
+    {
+        return nullptr;
+    }
+
+    // compact emotes and channel point rewards stick out of their line by a
+    // few pixels, so the neighbouring lines have to be checked as well
+    auto line = this->lineAt(point.y());
+    auto first = line == 0 ? 0 : line - 1;
+    auto last = std::min(line + 1, this->lines_.size() - 1);
+
+    for (auto i = first; i <= last; i++)
     {
+        if (auto *element = this->getElementAt(this->lines_[i], point))
+        {
+            return element;
+        }
+    }
+
+    return nullptr;
+}
+
+MessageLayoutElement *MessageLayoutContainer::getElementAt(const Line &line,
+                                                           QPoint point)
+{
+    auto begin = this->elementBounds_.begin() + line.startIndex;
+    auto end = this->elementBounds_.begin() + line.endIndex;
+
+    // only elements between the first one reaching past x and the first one
+    // from which on everything starts after x can contain the point
+    auto from = std::lower_bound(begin, end, point.x(),
+                                 [](const ElementBounds &bounds, int x) {
+                                     return bounds.maxRight < x;
+                                 });
+    auto to = std::upper_bound(from, end, point.x(),
+                               [](int x, const ElementBounds &bounds) {
+                                   return x < bounds.minLeft;
+                               });
+
+    for (auto it = from; it != to; it++)
+    {
+        auto &element = this->elements_[it - this->elementBounds_.begin()];
+
         if (element->getRect().contains(point))
         {
             return element.get();
@@ -346,6 +470,9 @@ MessageLayoutElement *MessageLayoutContainer::getElementAt(QPoint point)
 // painting
 void MessageLayoutContainer::paintElements(QPainter &painter)
 {
+    ImageAtlasBatch batch;
+    std::vector<MessageLayoutElement *> overlays;
+
     for (const std::unique_ptr<MessageLayoutElement> &element : this->elements_)
     {
 #ifdef FOURTF
@@ -353,6 +480,20 @@ void MessageLayoutContainer::paintElements(QPainter &painter)
         painter.drawRect(element->getRect());
 #endif
 
+        // zero width emotes have to be drawn on top of the batched emotes
+        if (element->getFlags().has(MessageElementFlag::ZeroWidthEmote))
+        {
+            overlays.push_back(element.get());
+            continue;
+        }
+
+        element->paintBatched(painter, batch);
+    }
+
+    batch.paint(painter);
+
+    for (auto *element : overlays)
+    {
         element->paint(painter);
     }
 }
@@ -366,6 +507,14 @@ void MessageLayoutContainer::paintAnimatedElements(QPainter &painter,
     }
 }
 
+void MessageLayoutContainer::markImagesUsed() const
+{
+    for (const std::unique_ptr<MessageLayoutElement> &element : this->elements_)
+    {
+        element->markImagesUsed();
+    }
+}
+
 void MessageLayoutContainer::paintSelection(QPainter &painter, int messageIndex,
                                             Selection &selection, int yOffset)
 {
@@ -558,62 +707,31 @@ void MessageLayoutContainer::paintSelection(QPainter &painter, int messageIndex,
 // selection
 int MessageLayoutContainer::getSelectionIndex(QPoint point)
 {
-    if (this->elements_.size() == 0)
+    if (this->lines_.empty())
     {
         return 0;
     }
 
-    auto line = this->lines_.begin();
-
-    for (; line != this->lines_.end(); line++)
-    {
-        if (line->rect.contains(point))
-        {
-            break;
-        }
-    }
+    auto &line = this->lines_[this->lineAt(point.y())];
 
-    int lineStart = line == this->lines_.end() ? this->lines_.back().startIndex
-                                               : line->startIndex;
-    if (line != this->lines_.end())
-    {
-        line++;
-    }
-    int lineEnd =
-        line == this->lines_.end() ? this->elements_.size() : line->startIndex;
+    auto begin = this->elementBounds_.begin() + line.startIndex;
+    auto end = this->elementBounds_.begin() + line.endIndex;
 
-    int index = 0;
+    // the first element whose right edge (including the trailing space) is
+    // past the point is the word
+    auto it = std::lower_bound(begin, end, point.x(),
+                               [](const ElementBounds &bounds, int x) {
+                                   return bounds.maxSelectionRight < x;
+                               });
 
-    for (int i = 0; i < lineEnd; i++)
+    if (it == end)
     {
-        auto &&element = this->elements_[i];
-
-        // end of line
-        if (i == lineEnd)
-        {
-            break;
-        }
-
-        // before line
-        if (i < lineStart)
-        {
-            index += element->getSelectionIndexCount();
-            continue;
-        }
-
-        // this is the word
-        auto rightMargin = element->hasTrailingSpace() ? this->spaceWidth_ : 0;
-
-        if (point.x() <= element->getRect().right() + rightMargin)
-        {
-            index += element->getMouseOverIndex(point);
-            break;
-        }
-
-        index += element->getSelectionIndexCount();
+        return line.endCharIndex;
     }
 
-    return index;
+    auto &element = this->elements_[it - this->elementBounds_.begin()];
+
+    return it->charIndex + element->getMouseOverIndex(point);
 }
 
 // fourtf: no idea if this is acurate LOL
@@ -17,6 +17,9 @@ namespace chatterino {
 enum class MessageFlag : uint32_t;
 using MessageFlags = FlagsEnum<MessageFlag>;
 
+struct SettingsSnapshot;
+using SettingsSnapshotPtr = std::shared_ptr<const SettingsSnapshot>;
+
 struct Margin {
     int top;
     int right;
@@ -52,9 +55,12 @@ struct MessageLayoutContainer {
     int getHeight() const;
     int getWidth() const;
     float getScale() const;
+    // The settings the container is laid out with. Only valid after begin().
+    const SettingsSnapshot &getSettingsSnapshot() const;
 
     // methods
-    void begin(int width_, float scale_, MessageFlags flags_);
+    void begin(int width_, float scale_, MessageFlags flags_,
+               SettingsSnapshotPtr settings);
     void end();
 
     void clear();
@@ -69,6 +75,9 @@ struct MessageLayoutContainer {
     // painting
     void paintElements(QPainter &painter);
     void paintAnimatedElements(QPainter &painter, int yOffset);
+    // Keeps the images of a layout that is painted from its buffer from
+    // being dropped by the ImageMemoryManager.
+    void markImagesUsed() const;
     void paintSelection(QPainter &painter, int messageIndex,
                         Selection &selection, int yOffset);
 
@@ -80,6 +89,13 @@ struct MessageLayoutContainer {
 
     bool isCollapsed();
 
+    // Remembers an image the layout would look different with once it's
+    // loaded. Loaded and empty images are ignored.
+    void addPendingImage(const ImagePtr &image);
+    // Returns true if one of the pending images finished loading (or failed
+    // to) and the container has to be laid out again.
+    bool pendingImagesChanged() const;
+
 private:
     struct Line {
         int startIndex;
@@ -89,14 +105,32 @@ private:
         QRect rect;
     };
 
+    // Hit-testing index, one entry per element. The edges are accumulated
+    // from the start (maxRight) or the end (minLeft) of the element's line,
+    // so they are sorted within each line and can be binary searched even
+    // though zero width emotes overlap their neighbours.
+    struct ElementBounds {
+        int minLeft;
+        int maxRight;
+        // like maxRight, but including the trailing space
+        int maxSelectionRight;
+        // selection index of the element's first character
+        int charIndex;
+    };
+
     // helpers
     void _addElement(MessageLayoutElement *element, bool forceAdd = false);
     bool canCollapse();
+    void buildIndex();
+    // Returns the index of the line at `y`, clamped to the existing lines.
+    size_t lineAt(int y) const;
+    MessageLayoutElement *getElementAt(const Line &line, QPoint point);
 
     // variables
     float scale_ = 1.f;
     int width_ = 0;
     MessageFlags flags_{};
+    SettingsSnapshotPtr settings_;
     int line_ = 0;
     int height_ = 0;
     int currentX_ = 0;
@@ -112,6 +146,8 @@ private:
 
     std::vector<std::unique_ptr<MessageLayoutElement>> elements_;
     std::vector<Line> lines_;
+    std::vector<ElementBounds> elementBounds_;
+    std::vector<ImagePtr> pendingImages_;
 };
 
 }  // namespace chatterino
@@ -5,6 +5,7 @@
 #include "messages/Emote.hpp"
 #include "messages/Image.hpp"
 #include "messages/MessageElement.hpp"
+#include "messages/layouts/ImageAtlas.hpp"
 #include "providers/twitch/TwitchEmotes.hpp"
 #include "singletons/Theme.hpp"
 #include "util/DebugCount.hpp"
@@ -13,6 +14,16 @@
 #include <QPainter>
 
 namespace chatterino {
+namespace {
+
+    // size of `rect` in device pixels, images scaled to it are drawn 1:1
+    QSize deviceSize(QPainter &painter, const QRect &rect)
+    {
+        return (QSizeF(rect.size()) * painter.device()->devicePixelRatioF())
+            .toSize();
+    }
+
+}  // namespace
 
 const QRect &MessageLayoutElement::getRect() const
 {
@@ -91,6 +102,16 @@ FlagsEnum<MessageElementFlag> MessageLayoutElement::getFlags() const
     return this->creator_.getFlags();
 }
 
+void MessageLayoutElement::paintBatched(QPainter &painter,
+                                        ImageAtlasBatch & /*batch*/)
+{
+    this->paint(painter);
+}
+
+void MessageLayoutElement::markImagesUsed() const
+{
+}
+
 //
 // IMAGE
 //
@@ -131,14 +152,36 @@ void ImageLayoutElement::paint(QPainter &painter)
         return;
     }
 
-    auto pixmap = this->image_->pixmapOrLoad();
-    if (pixmap && !this->image_->animated())
+    // animated images are painted by paintAnimated
+    if (this->image_->animated())
+    {
+        return;
+    }
+
+    auto pixmap = this->image_->scaledPixmapOrLoad(
+        deviceSize(painter, this->getRect()));
+    if (pixmap)
     {
         // fourtf: make it use qreal values
         painter.drawPixmap(QRectF(this->getRect()), *pixmap, QRectF());
     }
 }
 
+void ImageLayoutElement::paintBatched(QPainter &painter,
+                                      ImageAtlasBatch &batch)
+{
+    if (this->image_ == nullptr)
+    {
+        return;
+    }
+
+    if (!batch.add(this->image_, QRectF(this->getRect()),
+                   painter.device()->devicePixelRatioF()))
+    {
+        this->paint(painter);
+    }
+}
+
 void ImageLayoutElement::paintAnimated(QPainter &painter, int yOffset)
 {
     if (this->image_ == nullptr)
@@ -148,7 +191,8 @@ void ImageLayoutElement::paintAnimated(QPainter &painter, int yOffset)
 
     if (this->image_->animated())
     {
-        if (auto pixmap = this->image_->pixmapOrLoad())
+        if (auto pixmap = this->image_->scaledPixmapOrLoad(
+                deviceSize(painter, this->getRect())))
         {
             auto rect = this->getRect();
             rect.moveTop(rect.y() + yOffset);
@@ -157,6 +201,14 @@ void ImageLayoutElement::paintAnimated(QPainter &painter, int yOffset)
     }
 }
 
+void ImageLayoutElement::markImagesUsed() const
+{
+    if (this->image_ != nullptr)
+    {
+        this->image_->markUsed();
+    }
+}
+
 int ImageLayoutElement::getMouseOverIndex(const QPoint &abs) const
 {
     return 0;
@@ -196,8 +248,15 @@ void ImageWithBackgroundLayoutElement::paint(QPainter &painter)
         return;
     }
 
-    auto pixmap = this->image_->pixmapOrLoad();
-    if (pixmap && !this->image_->animated())
+    // animated images are painted by paintAnimated
+    if (this->image_->animated())
+    {
+        return;
+    }
+
+    auto pixmap = this->image_->scaledPixmapOrLoad(
+        deviceSize(painter, this->getRect()));
+    if (pixmap)
     {
         painter.fillRect(QRectF(this->getRect()), this->color_);
 
@@ -206,12 +265,33 @@ void ImageWithBackgroundLayoutElement::paint(QPainter &painter)
     }
 }
 
+void ImageWithBackgroundLayoutElement::paintBatched(QPainter &painter,
+                                                    ImageAtlasBatch &batch)
+{
+    if (this->image_ == nullptr)
+    {
+        return;
+    }
+
+    // the batch is drawn after all elements, so the background stays below
+    if (batch.add(this->image_, QRectF(this->getRect()),
+                  painter.device()->devicePixelRatioF()))
+    {
+        painter.fillRect(QRectF(this->getRect()), this->color_);
+    }
+    else
+    {
+        this->paint(painter);
+    }
+}
+
 //
 // TEXT
 //
 
 TextLayoutElement::TextLayoutElement(MessageElement &_creator, QString &_text,
-                                     const QSize &_size, QColor _color,
+                                     const QSize &_size,
+                                     const MessageColor &_color,
                                      FontStyle _style, float _scale)
     : MessageLayoutElement(_creator, _size)
     , color_(_color)
@@ -252,7 +332,7 @@ void TextLayoutElement::paint(QPainter &painter)
 {
     auto app = getApp();
 
-    painter.setPen(this->color_);
+    painter.setPen(this->color_.getNormalizedColor(*app->themes));
 
     painter.setFont(app->fonts->getFont(this->style_, this->scale_));
 
@@ -413,7 +493,8 @@ int TextIconLayoutElement::getXFromIndex(int index)
 MultiColorTextLayoutElement::MultiColorTextLayoutElement(
     MessageElement &_creator, QString &_text, const QSize &_size,
     std::vector<PajSegment> segments, FontStyle _style, float _scale)
-    : TextLayoutElement(_creator, _text, _size, QColor{}, _style, _scale)
+    : TextLayoutElement(_creator, _text, _size, MessageColor::Text, _style,
+                        _scale)
     , segments_(segments)
 {
     this->setText(_text);
@@ -423,8 +504,6 @@ void MultiColorTextLayoutElement::paint(QPainter &painter)
 {
     auto app = getApp();
 
-    painter.setPen(this->color_);
-
     painter.setFont(app->fonts->getFont(this->style_, this->scale_));
 
     int xOffset = 0;
@@ -434,7 +513,7 @@ void MultiColorTextLayoutElement::paint(QPainter &painter)
     for (const auto &segment : this->segments_)
     {
         qCDebug(chatterinoMessage) << "Draw segment:" << segment.text;
-        painter.setPen(segment.color);
+        painter.setPen(segment.color.getNormalizedColor(*app->themes));
         painter.drawText(QRectF(this->getRect().x() + xOffset,
                                 this->getRect().y(), 10000, 10000),
                          segment.text,
@@ -18,6 +18,7 @@ class MessageElement;
 class Image;
 using ImagePtr = std::shared_ptr<Image>;
 enum class FontStyle : uint8_t;
+class ImageAtlasBatch;
 
 class MessageLayoutElement : boost::noncopyable
 {
@@ -40,7 +41,12 @@ public:
                                      int to = INT_MAX) const = 0;
     virtual int getSelectionIndexCount() const = 0;
     virtual void paint(QPainter &painter) = 0;
+    // Like paint, but images that are in the image atlas are added to `batch`
+    // instead of being drawn right away.
+    virtual void paintBatched(QPainter &painter, ImageAtlasBatch &batch);
     virtual void paintAnimated(QPainter &painter, int yOffset) = 0;
+    // Called instead of paint when the element is drawn from a buffer.
+    virtual void markImagesUsed() const;
     virtual int getMouseOverIndex(const QPoint &abs) const = 0;
     virtual int getXFromIndex(int index) = 0;
 
@@ -71,7 +77,9 @@ protected:
                              int to = INT_MAX) const override;
     int getSelectionIndexCount() const override;
     void paint(QPainter &painter) override;
+    void paintBatched(QPainter &painter, ImageAtlasBatch &batch) override;
     void paintAnimated(QPainter &painter, int yOffset) override;
+    void markImagesUsed() const override;
     int getMouseOverIndex(const QPoint &abs) const override;
     int getXFromIndex(int index) override;
 
@@ -86,6 +94,7 @@ public:
 
 protected:
     void paint(QPainter &painter) override;
+    void paintBatched(QPainter &painter, ImageAtlasBatch &batch) override;
 
 private:
     QColor color_;
@@ -95,9 +104,11 @@ private:
 class TextLayoutElement : public MessageLayoutElement
 {
 public:
+    // The color is resolved against the current theme when painting, so theme
+    // changes don't require a new layout.
     TextLayoutElement(MessageElement &creator_, QString &text,
-                      const QSize &size, QColor color_, FontStyle style_,
-                      float scale_);
+                      const QSize &size, const MessageColor &color_,
+                      FontStyle style_, float scale_);
 
     void listenToLinkChanges();
 
@@ -110,7 +121,7 @@ protected:
     int getMouseOverIndex(const QPoint &abs) const override;
     int getXFromIndex(int index) override;
 
-    QColor color_;
+    MessageColor color_;
     FontStyle style_;
     float scale_;
 
@@ -142,7 +153,7 @@ private:
 
 struct PajSegment {
     QString text;
-    QColor color;
+    MessageColor color;
 };
 
 // TEXT
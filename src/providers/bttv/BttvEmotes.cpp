@@ -7,6 +7,7 @@
 #include "common/NetworkRequest.hpp"
 #include "common/QLogging.hpp"
 #include "messages/Emote.hpp"
+#include "messages/EmoteSnapshot.hpp"
 #include "messages/Image.hpp"
 #include "messages/ImageSet.hpp"
 #include "messages/MessageBuilder.hpp"
@@ -141,14 +142,23 @@ boost::optional<EmotePtr> BttvEmotes::emote(const EmoteName &name) const
 
 void BttvEmotes::loadEmotes()
 {
+    // shown until the emotes are fetched
+    if (auto snapshot = readEmoteMapSnapshot("bttv-global"))
+    {
+        this->global_.set(std::make_shared<EmoteMap>(std::move(*snapshot)));
+    }
+
     NetworkRequest(QString(globalEmoteApiUrl))
         .timeout(30000)
         .onSuccess([this](auto result) -> Outcome {
             auto emotes = this->global_.get();
             auto pair = parseGlobalEmotes(result.parseJsonArray(), *emotes);
             if (pair.first)
+            {
+                writeEmoteMapSnapshot("bttv-global", pair.second);
                 this->global_.set(
                     std::make_shared<EmoteMap>(std::move(pair.second)));
+            }
             return pair.first;
         })
         .execute();
@@ -162,8 +172,7 @@ void BttvEmotes::loadChannel(std::weak_ptr<Channel> channel,
 {
     NetworkRequest(QString(bttvChannelEmoteApiUrl) + channelId)
         .timeout(20000)
-        .onSuccess([callback = std::move(callback), channel,
-                    &channelDisplayName,
+        .onSuccess([callback, channel, &channelDisplayName,
                     manualRefresh](auto result) -> Outcome {
             auto pair =
                 parseChannelEmotes(result.parseJson(), channelDisplayName);
@@ -188,13 +197,15 @@ void BttvEmotes::loadChannel(std::weak_ptr<Channel> channel,
             }
             return pair.first;
         })
-        .onError([channelId, channel, manualRefresh](auto result) {
+        .onError([channelId, channel, manualRefresh,
+                  callback = std::move(callback)](auto result) {
             auto shared = channel.lock();
             if (!shared)
                 return;
             if (result.status() == 404)
             {
                 // User does not have any BTTV emotes
+                callback(EmoteMap());
                 if (manualRefresh)
                     shared->addMessage(
                         makeSystemMessage(CHANNEL_HAS_NO_EMOTES));
@@ -6,6 +6,7 @@
 #include "common/Outcome.hpp"
 #include "common/QLogging.hpp"
 #include "messages/Emote.hpp"
+#include "messages/EmoteSnapshot.hpp"
 #include "messages/Image.hpp"
 #include "messages/MessageBuilder.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
@@ -181,6 +182,12 @@ boost::optional<EmotePtr> FfzEmotes::emote(const EmoteName &name) const
 
 void FfzEmotes::loadEmotes()
 {
+    // shown until the emotes are fetched
+    if (auto snapshot = readEmoteMapSnapshot("ffz-global"))
+    {
+        this->global_.set(std::make_shared<EmoteMap>(std::move(*snapshot)));
+    }
+
     QString url("https://api.frankerfacez.com/v1/set/global");
 
     NetworkRequest(url)
@@ -190,8 +197,11 @@ void FfzEmotes::loadEmotes()
             auto emotes = this->emotes();
             auto pair = parseGlobalEmotes(result.parseJson(), *emotes);
             if (pair.first)
+            {
+                writeEmoteMapSnapshot("ffz-global", pair.second);
                 this->global_.set(
                     std::make_shared<EmoteMap>(std::move(pair.second)));
+            }
             return pair.first;
         })
         .execute();
@@ -210,7 +220,7 @@ void FfzEmotes::loadChannel(
     NetworkRequest("https://api.frankerfacez.com/v1/room/id/" + channelId)
 
         .timeout(20000)
-        .onSuccess([emoteCallback = std::move(emoteCallback),
+        .onSuccess([emoteCallback,
                     modBadgeCallback = std::move(modBadgeCallback),
                     vipBadgeCallback = std::move(vipBadgeCallback), channel,
                     manualRefresh](auto result) -> Outcome {
@@ -244,13 +254,16 @@ void FfzEmotes::loadChannel(
 
             return Success;
         })
-        .onError([channelId, channel, manualRefresh](NetworkResult result) {
+        .onError([channelId, channel, manualRefresh,
+                  emoteCallback = std::move(emoteCallback)](
+                     NetworkResult result) {
             auto shared = channel.lock();
             if (!shared)
                 return;
             if (result.status() == 404)
             {
                 // User does not have any FFZ emotes
+                emoteCallback(EmoteMap());
                 if (manualRefresh)
                     shared->addMessage(
                         makeSystemMessage(CHANNEL_HAS_NO_EMOTES));
@@ -0,0 +1,292 @@
+#include "providers/twitch/ChannelImagePrefetcher.hpp"
+
+#include "Application.hpp"
+#include "debug/AssertInGuiThread.hpp"
+#include "messages/Emote.hpp"
+#include "messages/Message.hpp"
+#include "messages/MessageElement.hpp"
+#include "singletons/Paths.hpp"
+#include "singletons/WindowManager.hpp"
+#include "util/DebugCount.hpp"
+#include "widgets/Window.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+
+    // images loaded when a channel is joined
+    constexpr int prefetchCount = 48;
+    // images whose counts are kept on disk
+    constexpr int maxEntries = 256;
+    constexpr int saveInterval = 5 * 60 * 1000;
+    // the prefetched images are kept alive until this many messages arrived,
+    // these hold on to the images they use
+    constexpr int releaseAfterMessages = 100;
+    constexpr int releaseTimeout = 60 * 1000;
+
+}  // namespace
+
+ChannelImagePrefetcher::ChannelImagePrefetcher()
+{
+    this->saveTimer_.setInterval(saveInterval);
+    QObject::connect(&this->saveTimer_, &QTimer::timeout, [this] {
+        this->save();
+    });
+
+    this->releaseTimer_.setSingleShot(true);
+    this->releaseTimer_.setInterval(releaseTimeout);
+    QObject::connect(&this->releaseTimer_, &QTimer::timeout, [this] {
+        this->releasePrefetched();
+    });
+}
+
+ChannelImagePrefetcher::~ChannelImagePrefetcher()
+{
+    this->save();
+}
+
+void ChannelImagePrefetcher::setRoomId(const QString &roomId)
+{
+    assertInGuiThread();
+
+    if (roomId == this->roomId_)
+    {
+        return;
+    }
+
+    this->save();
+
+    this->roomId_ = roomId;
+    this->entries_.clear();
+    this->releasePrefetched();
+
+    if (this->roomId_.isEmpty())
+    {
+        this->saveTimer_.stop();
+        return;
+    }
+
+    this->load();
+    this->prefetch();
+    this->saveTimer_.start();
+}
+
+void ChannelImagePrefetcher::addMessage(const Message &message)
+{
+    if (this->roomId_.isEmpty())
+    {
+        return;
+    }
+
+    for (const auto &element : message.elements)
+    {
+        // most elements are text, only cast the ones that can be images
+        auto flags = element->getFlags();
+        if (flags.hasAny({MessageElementFlag::EmoteImages,
+                          MessageElementFlag::EmojiImage,
+                          MessageElementFlag::BitsStatic,
+                          MessageElementFlag::BitsAnimated}))
+        {
+            if (auto emote = dynamic_cast<EmoteElement *>(element.get()))
+            {
+                this->addEmote(*emote->getEmote());
+            }
+        }
+        else if (flags.hasAny(MessageElementFlag::Badges))
+        {
+            if (auto badge = dynamic_cast<BadgeElement *>(element.get()))
+            {
+                this->addEmote(*badge->getEmote());
+            }
+        }
+    }
+
+    if (!this->prefetched_.empty() &&
+        ++this->messagesSincePrefetch_ >= releaseAfterMessages)
+    {
+        this->releasePrefetched();
+    }
+}
+
+void ChannelImagePrefetcher::addEmote(const Emote &emote)
+{
+    const ImagePtr images[] = {emote.images.getImage1(),
+                               emote.images.getImage2(),
+                               emote.images.getImage3()};
+
+    auto key = images[0]->url().string;
+    if (key.isEmpty())
+    {
+        return;
+    }
+
+    auto &entry = this->entries_[key];
+    if (entry.uses == 0)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            entry.urls[i] = images[i]->url();
+            entry.scales[i] = images[i]->scale();
+        }
+    }
+
+    entry.uses++;
+    this->dirty_ = true;
+}
+
+void ChannelImagePrefetcher::prefetch()
+{
+    std::vector<const Entry *> ranked;
+    ranked.reserve(size_t(this->entries_.size()));
+    for (const auto &entry : this->entries_)
+    {
+        ranked.push_back(&entry);
+    }
+
+    auto count = std::min(prefetchCount, int(ranked.size()));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                      [](auto &&a, auto &&b) {
+                          return a->uses > b->uses;
+                      });
+
+    // messages are laid out at the scale of their window
+    auto scale = getApp()->windows->getMainWindow().scale();
+
+    for (int i = 0; i < count; i++)
+    {
+        const auto &entry = *ranked[size_t(i)];
+
+        auto image = [&](int index) {
+            return entry.urls[index].string.isEmpty()
+                       ? Image::getEmpty()
+                       : Image::fromUrl(entry.urls[index],
+                                        entry.scales[index]);
+        };
+        ImageSet images(image(0), image(1), image(2));
+
+        auto &&chosen = images.getImage(scale);
+        chosen->load(ImageLoadPriority::Near);
+        this->prefetched_.push_back(chosen);
+    }
+
+    DebugCount::increase("prefetched images", count);
+
+    this->messagesSincePrefetch_ = 0;
+    this->releaseTimer_.start();
+}
+
+void ChannelImagePrefetcher::releasePrefetched()
+{
+    this->prefetched_.clear();
+    this->releaseTimer_.stop();
+}
+
+void ChannelImagePrefetcher::load()
+{
+    QFile file(this->path());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    auto images =
+        QJsonDocument::fromJson(file.readAll()).object().value("images");
+
+    for (auto value : images.toArray())
+    {
+        auto object = value.toObject();
+        auto urls = object.value("urls").toArray();
+        auto scales = object.value("scales").toArray();
+
+        Entry entry;
+        for (int i = 0; i < 3; i++)
+        {
+            entry.urls[i] = Url{urls.at(i).toString()};
+            entry.scales[i] = scales.at(i).toDouble(entry.scales[i]);
+        }
+
+        // older sessions count less, so images that aren't used anymore
+        // eventually drop out
+        entry.uses = int64_t(object.value("uses").toDouble()) * 3 / 4;
+
+        if (entry.uses > 0 && !entry.urls[0].string.isEmpty())
+        {
+            this->entries_.insert(entry.urls[0].string, entry);
+        }
+    }
+}
+
+void ChannelImagePrefetcher::save()
+{
+    if (!this->dirty_ || this->roomId_.isEmpty())
+    {
+        return;
+    }
+
+    std::vector<const Entry *> ranked;
+    ranked.reserve(size_t(this->entries_.size()));
+    for (const auto &entry : this->entries_)
+    {
+        ranked.push_back(&entry);
+    }
+
+    std::sort(ranked.begin(), ranked.end(), [](auto &&a, auto &&b) {
+        return a->uses > b->uses;
+    });
+    ranked.resize(std::min(ranked.size(), size_t(maxEntries)));
+
+    QJsonArray images;
+    for (const auto *entry : ranked)
+    {
+        QJsonArray urls;
+        QJsonArray scales;
+        for (int i = 0; i < 3; i++)
+        {
+            urls.append(entry->urls[i].string);
+            scales.append(entry->scales[i]);
+        }
+
+        QJsonObject object;
+        object.insert("urls", urls);
+        object.insert("scales", scales);
+        object.insert("uses", double(entry->uses));
+        images.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("images", images);
+
+    QDir().mkpath(QFileInfo(this->path()).absolutePath());
+
+    QSaveFile file(this->path());
+    file.open(QIODevice::WriteOnly);
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+
+    // the entries that weren't saved would be gone after a restart anyway
+    QHash<QString, Entry> saved;
+    for (const auto *entry : ranked)
+    {
+        saved.insert(entry->urls[0].string, *entry);
+    }
+    this->entries_ = std::move(saved);
+
+    this->dirty_ = false;
+}
+
+QString ChannelImagePrefetcher::path() const
+{
+    return getPaths()->cacheDirectory() + "/channel-images/" + this->roomId_ +
+           ".json";
+}
+
+}  // namespace chatterino
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common/Aliases.hpp"
+#include "messages/Image.hpp"
+
+#include <QHash>
+#include <QString>
+#include <QTimer>
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace chatterino {
+
+struct Emote;
+struct Message;
+
+/// Counts how often the emotes and badges of a channel are used and keeps
+/// the counts on disk. When the channel is joined again, the most used ones
+/// are loaded before the first messages arrive, so these messages don't
+/// move around while their images load.
+///
+/// Gui thread only.
+class ChannelImagePrefetcher : boost::noncopyable
+{
+public:
+    ChannelImagePrefetcher();
+    ~ChannelImagePrefetcher();
+
+    // Saves the counts of the previous room, loads the ones of `roomId` and
+    // starts loading the most used images.
+    void setRoomId(const QString &roomId);
+    void addMessage(const Message &message);
+
+private:
+    struct Entry {
+        // the 1x, 2x and 3x image
+        Url urls[3];
+        qreal scales[3] = {1, 0.5, 0.25};
+        int64_t uses = 0;
+    };
+
+    void addEmote(const Emote &emote);
+    void prefetch();
+    void releasePrefetched();
+    void load();
+    void save();
+    QString path() const;
+
+    QString roomId_;
+    // by the url of the 1x image, trimmed to the saved entries on every save
+    QHash<QString, Entry> entries_;
+    bool dirty_ = false;
+    QTimer saveTimer_;
+    // kept alive until the first messages using them arrived
+    std::vector<ImagePtr> prefetched_;
+    int messagesSincePrefetch_ = 0;
+    QTimer releaseTimer_;
+};
+
+}  // namespace chatterino
@@ -12,6 +12,7 @@
 #include "common/Outcome.hpp"
 #include "common/QLogging.hpp"
 #include "messages/Emote.hpp"
+#include "messages/EmoteSnapshot.hpp"
 
 namespace chatterino {
 
@@ -27,11 +28,23 @@ void TwitchBadges::loadTwitchBadges()
     static QString url(
         "https://badges.twitch.tv/v1/badges/global/display?language=en");
 
+    // shown until the badges are fetched
+    if (auto snapshot = readEmoteSnapshot("twitch-badges-global"))
+    {
+        auto badgeSets = this->badgeSets_.access();
+        for (const auto &[key, emote] : *snapshot)
+        {
+            auto slash = key.lastIndexOf('/');
+            (*badgeSets)[key.left(slash)][key.mid(slash + 1)] = emote;
+        }
+    }
+
     NetworkRequest(url)
         .onSuccess([this](auto result) -> Outcome {
             {
                 auto root = result.parseJson();
                 auto badgeSets = this->badgeSets_.access();
+                EmoteSnapshot snapshot;
 
                 auto jsonSets = root.value("badge_sets").toObject();
                 for (auto sIt = jsonSets.begin(); sIt != jsonSets.end(); ++sIt)
@@ -63,10 +76,13 @@ void TwitchBadges::loadTwitchBadges()
                         // "title"
                         // "clickAction"
 
-                        (*badgeSets)[key][vIt.key()] =
-                            std::make_shared<Emote>(emote);
+                        auto badge = std::make_shared<Emote>(emote);
+                        (*badgeSets)[key][vIt.key()] = badge;
+                        snapshot.emplace_back(key + "/" + vIt.key(), badge);
                     }
                 }
+
+                writeEmoteSnapshot("twitch-badges-global", snapshot);
             }
             this->loaded();
             return Success;
@@ -6,6 +6,7 @@
 #include "common/NetworkRequest.hpp"
 #include "controllers/accounts/AccountController.hpp"
 #include "controllers/notifications/NotificationController.hpp"
+#include "messages/EmoteSnapshot.hpp"
 #include "messages/Message.hpp"
 #include "providers/bttv/BttvEmotes.hpp"
 #include "providers/bttv/LoadBttvChannelEmote.hpp"
@@ -175,6 +176,8 @@ TwitchChannel::TwitchChannel(const QString &name, BttvEmotes &bttv,
 
     // room id loaded -> refresh live status
     this->roomIdChanged.connect([this]() {
+        // before anything else so the images are requested first
+        this->imagePrefetcher_.setRoomId(this->roomId());
         this->refreshPubsub();
         this->refreshTitle();
         this->refreshLiveStatus();
@@ -184,6 +187,17 @@ TwitchChannel::TwitchChannel(const QString &name, BttvEmotes &bttv,
         this->refreshBTTVChannelEmotes(false);
     });
 
+    // count the emotes and badges used in this channel
+    this->messageAppended.connect([this](auto &message, auto) {
+        this->imagePrefetcher_.addMessage(*message);
+    });
+    this->messagesAddedAtStart.connect([this](auto &messages) {
+        for (const auto &message : messages)
+        {
+            this->imagePrefetcher_.addMessage(*message);
+        }
+    });
+
     // timers
     QObject::connect(&this->chattersListTimer_, &QTimer::timeout, [=] {
         this->refreshChatters();
@@ -242,24 +256,72 @@ void TwitchChannel::setLocalizedName(const QString &name)
 
 void TwitchChannel::refreshBTTVChannelEmotes(bool manualRefresh)
 {
+    auto snapshotName = "bttv-channel-" + this->roomId();
+
+    // shown until the emotes are fetched
+    if (this->bttvEmotes_.get()->empty())
+    {
+        if (auto snapshot = readEmoteMapSnapshot(snapshotName))
+        {
+            this->bttvEmotes_.set(
+                std::make_shared<EmoteMap>(std::move(*snapshot)));
+        }
+    }
+
     BttvEmotes::loadChannel(
         weakOf<Channel>(this), this->roomId(), this->getLocalizedName(),
-        [this, weak = weakOf<Channel>(this)](auto &&emoteMap) {
+        [this, weak = weakOf<Channel>(this), snapshotName](auto &&emoteMap) {
             if (auto shared = weak.lock())
+            {
+                // the snapshot of a channel without emotes would show the
+                // old ones on the next start
+                if (emoteMap.empty())
+                {
+                    removeEmoteSnapshot(snapshotName);
+                }
+                else
+                {
+                    writeEmoteMapSnapshot(snapshotName, emoteMap);
+                }
                 this->bttvEmotes_.set(
                     std::make_shared<EmoteMap>(std::move(emoteMap)));
+            }
         },
         manualRefresh);
 }
 
 void TwitchChannel::refreshFFZChannelEmotes(bool manualRefresh)
 {
+    auto snapshotName = "ffz-channel-" + this->roomId();
+
+    // shown until the emotes are fetched
+    if (this->ffzEmotes_.get()->empty())
+    {
+        if (auto snapshot = readEmoteMapSnapshot(snapshotName))
+        {
+            this->ffzEmotes_.set(
+                std::make_shared<EmoteMap>(std::move(*snapshot)));
+        }
+    }
+
     FfzEmotes::loadChannel(
         weakOf<Channel>(this), this->roomId(),
-        [this, weak = weakOf<Channel>(this)](auto &&emoteMap) {
+        [this, weak = weakOf<Channel>(this), snapshotName](auto &&emoteMap) {
             if (auto shared = weak.lock())
+            {
+                // the snapshot of a channel without emotes would show the
+                // old ones on the next start
+                if (emoteMap.empty())
+                {
+                    removeEmoteSnapshot(snapshotName);
+                }
+                else
+                {
+                    writeEmoteMapSnapshot(snapshotName, emoteMap);
+                }
                 this->ffzEmotes_.set(
                     std::make_shared<EmoteMap>(std::move(emoteMap)));
+            }
         },
         [this, weak = weakOf<Channel>(this)](auto &&modBadge) {
             if (auto shared = weak.lock())
@@ -908,15 +970,36 @@ void TwitchChannel::refreshBadges()
 {
     auto url = Url{"https://badges.twitch.tv/v1/badges/channels/" +
                    this->roomId() + "/display?language=en"};
+    auto snapshotName = "twitch-badges-" + this->roomId();
+
+    // shown until the badges are fetched
+    if (!this->roomId().isEmpty())
+    {
+        auto badgeSets = this->badgeSets_.access();
+        if (badgeSets->empty())
+        {
+            if (auto snapshot = readEmoteSnapshot(snapshotName))
+            {
+                for (const auto &[key, emote] : *snapshot)
+                {
+                    auto slash = key.lastIndexOf('/');
+                    (*badgeSets)[key.left(slash)].emplace(key.mid(slash + 1),
+                                                          emote);
+                }
+            }
+        }
+    }
+
     NetworkRequest(url.string)
 
-        .onSuccess([this,
-                    weak = weakOf<Channel>(this)](auto result) -> Outcome {
+        .onSuccess([this, weak = weakOf<Channel>(this),
+                    snapshotName](auto result) -> Outcome {
             auto shared = weak.lock();
             if (!shared)
                 return Failure;
 
             auto badgeSets = this->badgeSets_.access();
+            EmoteSnapshot snapshot;
 
             auto jsonRoot = result.parseJson();
 
@@ -943,10 +1026,15 @@ void TwitchChannel::refreshBadges()
                         Tooltip{jsonVersion["description"].toString()},
                         Url{jsonVersion["clickURL"].toString()}});
 
-                    versions.emplace(jsonVersion_.key(), emote);
+                    // replaces badges from the snapshot
+                    versions[jsonVersion_.key()] = emote;
+                    snapshot.emplace_back(
+                        jsonBadgeSet.key() + "/" + jsonVersion_.key(), emote);
                 };
             }
 
+            writeEmoteSnapshot(snapshotName, snapshot);
+
             return Success;
         })
         .execute();
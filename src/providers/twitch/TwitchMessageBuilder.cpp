@@ -136,7 +136,7 @@ bool TwitchMessageBuilder::isIgnored() const
 
     auto app = getApp();
 
-    if (getSettings()->enableTwitchBlockedUsers &&
+    if (this->settings_->enableTwitchBlockedUsers &&
         this->tags.contains("user-id"))
     {
         auto sourceUserID = this->tags.value("user-id").toString();
@@ -147,7 +147,7 @@ bool TwitchMessageBuilder::isIgnored() const
         if (auto it = blocks->find(sourceUserID); it != blocks->end())
         {
             switch (static_cast<ShowIgnoredUsersMessages>(
-                getSettings()->showBlockedUsersMessages.getValue()))
+                this->settings_->showBlockedUsersMessages))
             {
                 case ShowIgnoredUsersMessages::IfModerator:
                     if (this->channel->isMod() ||
@@ -319,7 +319,8 @@ MessagePtr TwitchMessageBuilder::build()
     this->parseHighlights();
 
     // highlighting incoming whispers if requested per setting
-    if (this->args.isReceivedWhisper && getSettings()->highlightInlineWhispers)
+    if (this->args.isReceivedWhisper &&
+        this->settings_->highlightInlineWhispers)
     {
         this->message().flags.set(MessageFlag::HighlightedWhisper, true);
         this->message().highlightColor =
@@ -483,7 +484,8 @@ void TwitchMessageBuilder::addTextOrEmoji(const QString &string_)
             QString username = match.captured(1);
             auto originalTextColor = textColor;
 
-            if (this->twitchChannel != nullptr && getSettings()->colorUsernames)
+            if (this->twitchChannel != nullptr &&
+                this->settings_->colorUsernames)
             {
                 if (auto userColor =
                         this->twitchChannel->getUserColor(username);
@@ -514,7 +516,7 @@ void TwitchMessageBuilder::addTextOrEmoji(const QString &string_)
         }
     }
 
-    if (this->twitchChannel != nullptr && getSettings()->findAllUsernames)
+    if (this->twitchChannel != nullptr && this->settings_->findAllUsernames)
     {
         auto match = allUsernamesMentionRegex.match(string);
         QString username = match.captured(1);
@@ -524,7 +526,7 @@ void TwitchMessageBuilder::addTextOrEmoji(const QString &string_)
         {
             auto originalTextColor = textColor;
 
-            if (getSettings()->colorUsernames)
+            if (this->settings_->colorUsernames)
             {
                 if (auto userColor =
                         this->twitchChannel->getUserColor(username);
@@ -599,7 +601,7 @@ void TwitchMessageBuilder::parseUsernameColor()
         }
     }
 
-    if (getSettings()->colorizeNicknames && this->tags.contains("user-id"))
+    if (this->settings_->colorizeNicknames && this->tags.contains("user-id"))
     {
         this->usernameColor_ = getRandomColor(this->tags.value("user-id"));
         this->message().usernameColor = this->usernameColor_;
@@ -671,7 +673,7 @@ void TwitchMessageBuilder::appendUsername()
     // The full string that will be rendered in the chat widget
     QString usernameText;
 
-    switch (getSettings()->usernameDisplayMode.getValue())
+    switch (this->settings_->usernameDisplayMode)
     {
         case UsernameDisplayMode::Username: {
             usernameText = username;
@@ -1107,7 +1109,7 @@ void TwitchMessageBuilder::appendTwitchBadges()
             tooltip = QString("Twitch cheer %0").arg(cheerAmount);
         }
         else if (badge.key_ == "moderator" &&
-                 getSettings()->useCustomFfzModeratorBadges)
+                 this->settings_->useCustomFfzModeratorBadges)
         {
             if (auto customModBadge = this->twitchChannel->ffzCustomModBadge())
             {
@@ -1119,7 +1121,7 @@ void TwitchMessageBuilder::appendTwitchBadges()
                 continue;
             }
         }
-        else if (badge.key_ == "vip" && getSettings()->useCustomFfzVipBadges)
+        else if (badge.key_ == "vip" && this->settings_->useCustomFfzVipBadges)
         {
             if (auto customVipBadge = this->twitchChannel->ffzCustomVipBadge())
             {
@@ -1203,7 +1205,7 @@ Outcome TwitchMessageBuilder::tryParseCheermote(const QString &string)
 
     int cheerValue = match.captured(1).toInt();
 
-    if (getSettings()->stackBits)
+    if (this->settings_->stackBits)
     {
         if (this->bitsStacked)
         {
@@ -57,6 +57,7 @@ void Fonts::initialize(Settings &, Paths &)
             {
                 map.clear();
             }
+            this->generation_++;
             this->fontChanged.invoke();
         },
         false);
@@ -69,6 +70,7 @@ void Fonts::initialize(Settings &, Paths &)
             {
                 map.clear();
             }
+            this->generation_++;
             this->fontChanged.invoke();
         },
         false);
@@ -85,6 +87,7 @@ void Fonts::initialize(Settings &, Paths &)
             {
                 map.clear();
             }
+            this->generation_++;
             this->fontChanged.invoke();
         },
         false);
@@ -101,6 +104,11 @@ QFontMetrics Fonts::getFontMetrics(FontStyle type, float scale)
     return this->getOrCreateFontData(type, scale).metrics;
 }
 
+int Fonts::getGeneration() const
+{
+    return this->generation_;
+}
+
 Fonts::FontData &Fonts::getOrCreateFontData(FontStyle type, float scale)
 {
     assertInGuiThread();
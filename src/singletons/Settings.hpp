@@ -115,6 +115,8 @@ public:
     BoolSetting enableSmoothScrolling = {"/appearance/smoothScrolling", true};
     BoolSetting enableSmoothScrollingNewMessages = {
         "/appearance/smoothScrollingNewMessages", false};
+    BoolSetting lazyMessageBuffers = {"/appearance/messages/lazyBuffers",
+                                      true};
     BoolSetting boldUsernames = {"/appearance/messages/boldUsernames", true};
     BoolSetting colorUsernames = {"/appearance/messages/colorUsernames", true};
     BoolSetting findAllUsernames = {"/appearance/messages/findAllUsernames",
@@ -368,6 +370,12 @@ public:
     BoolSetting openLinksIncognito = {"/misc/openLinksIncognito", 0};
 
     QStringSetting cachePath = {"/cache/path", ""};
+    // in MiB
+    IntSetting imageMemoryBudget = {"/cache/imageMemoryBudget", 512};
+    IntSetting imageLoadConcurrency = {"/cache/imageLoadConcurrency", 12};
+    // in MiB
+    IntSetting diskCacheMaxSize = {"/cache/diskMaxSize", 1024};
+    IntSetting diskCacheMaxAge = {"/cache/diskMaxAgeDays", 30};
     BoolSetting restartOnCrash = {"/misc/restartOnCrash", false};
     BoolSetting attachExtensionToAnyProcess = {
         "/misc/attachExtensionToAnyProcess", false};
@@ -0,0 +1,126 @@
+#include "singletons/SettingsSnapshot.hpp"
+
+#include <pajlada/settings/settinglistener.hpp>
+
+#include <atomic>
+
+namespace chatterino {
+namespace {
+
+    SettingsSnapshotPtr makeSnapshot(int version)
+    {
+        auto *s = getSettings();
+        auto snapshot = std::make_shared<SettingsSnapshot>();
+
+        snapshot->version = version;
+
+        snapshot->hideModerated = s->hideModerated;
+        snapshot->hideModerationActions = s->hideModerationActions;
+        snapshot->hideSimilar = s->hideSimilar;
+        snapshot->compactEmotes = s->compactEmotes;
+        snapshot->removeSpacesBetweenEmotes = s->removeSpacesBetweenEmotes;
+        snapshot->collapseMessagesMinLines =
+            s->collpseMessagesMinLines.getValue();
+        snapshot->emoteScale = s->emoteScale.getValue();
+        snapshot->timestampFormat = s->timestampFormat.getValue();
+
+        snapshot->lazyMessageBuffers = s->lazyMessageBuffers;
+        snapshot->alternateMessages = s->alternateMessages;
+        snapshot->separateMessages = s->separateMessages;
+        snapshot->enableSubHighlight = s->enableSubHighlight;
+        snapshot->enableRedeemedHighlight = s->enableRedeemedHighlight;
+        snapshot->showLastMessageIndicator = s->showLastMessageIndicator;
+        snapshot->lastMessageColor = s->lastMessageColor.getValue();
+        snapshot->lastMessagePattern = s->lastMessagePattern;
+
+        snapshot->enableTwitchBlockedUsers = s->enableTwitchBlockedUsers;
+        snapshot->showBlockedUsersMessages =
+            s->showBlockedUsersMessages.getValue();
+        snapshot->highlightInlineWhispers = s->highlightInlineWhispers;
+        snapshot->colorUsernames = s->colorUsernames;
+        snapshot->findAllUsernames = s->findAllUsernames;
+        snapshot->colorizeNicknames = s->colorizeNicknames;
+        snapshot->usernameDisplayMode = s->usernameDisplayMode;
+        snapshot->useCustomFfzModeratorBadges = s->useCustomFfzModeratorBadges;
+        snapshot->useCustomFfzVipBadges = s->useCustomFfzVipBadges;
+        snapshot->stackBits = s->stackBits;
+
+        return snapshot;
+    }
+
+    class SnapshotHolder
+    {
+    public:
+        SnapshotHolder()
+        {
+            auto *s = getSettings();
+
+            // only these change how messages are laid out, so only they
+            // change the version
+            for (auto *setting :
+                 {&s->hideModerated, &s->hideModerationActions,
+                  &s->hideSimilar, &s->compactEmotes,
+                  &s->removeSpacesBetweenEmotes})
+            {
+                this->layoutListener_.addSetting(*setting);
+            }
+            this->layoutListener_.addSetting(s->collpseMessagesMinLines);
+            this->layoutListener_.addSetting(s->emoteScale);
+            this->layoutListener_.addSetting(s->timestampFormat);
+
+            for (auto *setting :
+                 {&s->lazyMessageBuffers, &s->alternateMessages,
+                  &s->separateMessages, &s->enableSubHighlight,
+                  &s->enableRedeemedHighlight, &s->showLastMessageIndicator,
+                  &s->enableTwitchBlockedUsers, &s->highlightInlineWhispers,
+                  &s->colorUsernames, &s->findAllUsernames,
+                  &s->colorizeNicknames, &s->useCustomFfzModeratorBadges,
+                  &s->useCustomFfzVipBadges, &s->stackBits})
+            {
+                this->listener_.addSetting(*setting);
+            }
+            this->listener_.addSetting(s->lastMessageColor);
+            this->listener_.addSetting(s->lastMessagePattern);
+            this->listener_.addSetting(s->showBlockedUsersMessages);
+            this->listener_.addSetting(s->usernameDisplayMode);
+
+            this->layoutListener_.setCB([this] {
+                this->update(true);
+            });
+            this->listener_.setCB([this] {
+                this->update(false);
+            });
+
+            this->update(true);
+        }
+
+        SettingsSnapshotPtr get() const
+        {
+            return std::atomic_load(&this->snapshot_);
+        }
+
+    private:
+        void update(bool layoutChanged)
+        {
+            auto version =
+                layoutChanged ? ++this->version_ : this->version_.load();
+            std::atomic_store(&this->snapshot_, makeSnapshot(version));
+        }
+
+        pajlada::SettingListener layoutListener_;
+        pajlada::SettingListener listener_;
+        std::atomic<int> version_{0};
+        SettingsSnapshotPtr snapshot_;
+    };
+
+}  // namespace
+
+SettingsSnapshotPtr SettingsSnapshot::current()
+{
+    // never destroyed, the settings listeners outlive everything using it
+    static auto *holder = new SnapshotHolder();
+
+    return holder->get();
+}
+
+}  // namespace chatterino
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "singletons/Settings.hpp"
+
+#include <QString>
+
+#include <memory>
+
+namespace chatterino {
+
+/// Plain copies of the settings that are read for every message or element
+/// while building, laying out and painting messages. Reading a setting object
+/// locks and copies its value, reading these is free.
+///
+/// Snapshots are never modified. When one of the settings changes, a new
+/// snapshot replaces the current one. Only the layout settings raise its
+/// version, so the version can be part of layout cache keys.
+///
+/// Safe to use from any thread.
+struct SettingsSnapshot {
+    int version = 0;
+
+    // layout
+    bool hideModerated = false;
+    bool hideModerationActions = false;
+    bool hideSimilar = false;
+    bool compactEmotes = true;
+    bool removeSpacesBetweenEmotes = false;
+    int collapseMessagesMinLines = 0;
+    float emoteScale = 1.f;
+    QString timestampFormat;
+
+    // painting
+    bool lazyMessageBuffers = true;
+    bool alternateMessages = false;
+    bool separateMessages = false;
+    bool enableSubHighlight = true;
+    bool enableRedeemedHighlight = true;
+    bool showLastMessageIndicator = false;
+    QString lastMessageColor;
+    Qt::BrushStyle lastMessagePattern = Qt::SolidPattern;
+
+    // message builders
+    bool enableTwitchBlockedUsers = true;
+    int showBlockedUsersMessages = 0;
+    bool highlightInlineWhispers = false;
+    bool colorUsernames = true;
+    bool findAllUsernames = false;
+    bool colorizeNicknames = true;
+    UsernameDisplayMode usernameDisplayMode =
+        UsernameDisplayMode::UsernameAndLocalizedName;
+    bool useCustomFfzModeratorBadges = true;
+    bool useCustomFfzVipBadges = true;
+    bool stackBits = false;
+
+    // Returns the snapshot of the current settings.
+    static std::shared_ptr<const SettingsSnapshot> current();
+};
+
+using SettingsSnapshotPtr = std::shared_ptr<const SettingsSnapshot>;
+
+}  // namespace chatterino
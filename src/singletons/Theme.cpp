@@ -1,4 +1,6 @@
 #define LOOKUP_COLOR_COUNT 360
+// username colors are random, don't let them grow the cache forever
+#define MAX_NORMALIZED_COLORS 4096
 
 #include "singletons/Theme.hpp"
 #include "Application.hpp"
@@ -31,6 +33,9 @@ void Theme::actuallyUpdate(double hue, double multiplier)
 {
     BaseTheme::actuallyUpdate(hue, multiplier);
 
+    this->generation_++;
+    this->normalizedColors_.clear();
+
     auto getColor = [multiplier](double h, double s, double l, double a = 1.0) {
         return QColor::fromHslF(h, s, ((l - 0.5) * multiplier) + 0.5, a);
     };
@@ -119,6 +124,31 @@ void Theme::normalizeColor(QColor &color)
     }
 }
 
+const QColor &Theme::getNormalizedColor(const QColor &color)
+{
+    auto it = this->normalizedColors_.find(color.rgba());
+    if (it != this->normalizedColors_.end())
+    {
+        return it->second;
+    }
+
+    if (this->normalizedColors_.size() >= MAX_NORMALIZED_COLORS)
+    {
+        this->normalizedColors_.clear();
+    }
+
+    auto normalized = color;
+    this->normalizeColor(normalized);
+
+    return this->normalizedColors_.emplace(color.rgba(), normalized)
+        .first->second;
+}
+
+int Theme::getGeneration() const
+{
+    return this->generation_;
+}
+
 Theme *getTheme()
 {
     return getApp()->themes;
@@ -9,6 +9,8 @@
 #include <pajlada/settings/setting.hpp>
 #include <singletons/Settings.hpp>
 
+#include <unordered_map>
+
 namespace chatterino {
 
 class WindowManager;
@@ -50,6 +52,13 @@ public:
 
     void normalizeColor(QColor &color);
 
+    // Returns `color` normalized for the current theme. Results are cached
+    // until the theme changes. Gui thread only.
+    const QColor &getNormalizedColor(const QColor &color);
+
+    // Increased whenever the theme colors change.
+    int getGeneration() const;
+
 private:
     void actuallyUpdate(double hue, double multiplier) override;
     void fillLookupTableValues(double (&array)[360], double from, double to,
@@ -60,6 +69,9 @@ private:
 
     pajlada::Signals::NoArgSignal repaintVisibleChatWidgets_;
 
+    int generation_ = 0;
+    std::unordered_map<QRgb, QColor> normalizedColors_;
+
     friend class WindowManager;
 };
 
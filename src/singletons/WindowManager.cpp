@@ -210,6 +210,12 @@ void WindowManager::layoutChannelViews(Channel *channel)
 void WindowManager::forceLayoutChannelViews()
 {
     this->incGeneration();
+    this->invalidateChannelViewBuffers();
+}
+
+void WindowManager::invalidateChannelViewBuffers()
+{
+    this->bufferGeneration_++;
     this->layoutChannelViews(nullptr);
 }
 
@@ -303,6 +309,11 @@ void WindowManager::initialize(Settings &settings, Paths &paths)
         this->repaintVisibleChatWidgets();
     });
 
+    // message layouts don't depend on the theme, only their buffers do
+    getApp()->themes->updated.connect([this] {
+        this->invalidateChannelViewBuffers();
+    });
+
     assert(!this->initialized_);
 
     {
@@ -353,16 +364,16 @@ void WindowManager::initialize(Settings &settings, Paths &paths)
         this->forceLayoutChannelViews();
     });
     settings.alternateMessages.connect([this](auto, auto) {
-        this->forceLayoutChannelViews();
+        this->invalidateChannelViewBuffers();
     });
     settings.separateMessages.connect([this](auto, auto) {
-        this->forceLayoutChannelViews();
+        this->invalidateChannelViewBuffers();
     });
     settings.collpseMessagesMinLines.connect([this](auto, auto) {
         this->forceLayoutChannelViews();
     });
     settings.enableRedeemedHighlight.connect([this](auto, auto) {
-        this->forceLayoutChannelViews();
+        this->invalidateChannelViewBuffers();
     });
 
     this->initialized_ = true;
@@ -645,6 +656,11 @@ void WindowManager::incGeneration()
     this->generation_++;
 }
 
+int WindowManager::getBufferGeneration() const
+{
+    return this->bufferGeneration_;
+}
+
 WindowLayout WindowManager::loadWindowLayoutFromFile() const
 {
     return WindowLayout::loadFromFile(this->windowLayoutFilePath);
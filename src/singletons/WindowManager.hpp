@@ -49,6 +49,11 @@ public:
     // This is called, for example, when the emote scale or timestamp format has
     // changed
     void forceLayoutChannelViews();
+    // Force all channel views to repaint their message buffers without redoing
+    // their layout
+    // This is called, for example, when the theme or the alternating message
+    // background setting has changed
+    void invalidateChannelViewBuffers();
     void repaintVisibleChatWidgets(Channel *channel = nullptr);
     void repaintGifEmotes();
 
@@ -68,6 +73,7 @@ public:
 
     int getGeneration() const;
     void incGeneration();
+    int getBufferGeneration() const;
 
     MessageElementFlags getWordFlags();
     void updateWordTypeMask();
@@ -115,6 +121,7 @@ private:
     QPoint emotePopupPos_;
 
     std::atomic<int> generation_{0};
+    std::atomic<int> bufferGeneration_{0};
 
     std::vector<Window *> windows_;
 
@@ -4,28 +4,215 @@
 #include "singletons/Settings.hpp"
 #include "singletons/WindowManager.hpp"
 
+#include <QApplication>
+#include <QEvent>
+#include <QWidget>
+
+#include <algorithm>
+#include <functional>
+
 namespace chatterino {
+namespace {
+
+    // Calls `changed` when a window is shown, hidden, minimized or restored.
+    class WindowStateFilter : public QObject
+    {
+    public:
+        WindowStateFilter(QObject *parent, std::function<void()> changed)
+            : QObject(parent)
+            , changed_(std::move(changed))
+        {
+        }
+
+        bool eventFilter(QObject *object, QEvent *event) override
+        {
+            switch (event->type())
+            {
+                case QEvent::Show:
+                case QEvent::Hide:
+                case QEvent::WindowStateChange:
+                    if (object->isWidgetType() &&
+                        static_cast<QWidget *>(object)->isWindow())
+                    {
+                        this->changed_();
+                    }
+                    break;
+
+                default:;
+            }
+
+            return false;
+        }
+
+    private:
+        std::function<void()> changed_;
+    };
+
+}  // namespace
 
 void GIFTimer::initialize()
 {
-    this->timer.setInterval(30);
+    this->clock_.start();
+
+    this->timer.setSingleShot(true);
+    this->timer.setTimerType(Qt::PreciseTimer);
 
     getSettings()->animateEmotes.connect([this](bool enabled, auto) {
+        this->pausedDirty_ = true;
+
         if (enabled)
-            this->timer.start();
+            this->resume();
         else
-            this->timer.stop();
+            this->clear();
+    });
+
+    getSettings()->animationsWhenFocused.connect([this](auto, auto) {
+        this->pausedDirty_ = true;
+        this->resume();
     });
 
     QObject::connect(&this->timer, &QTimer::timeout, [this] {
-        if (getSettings()->animationsWhenFocused &&
-            qApp->activeWindow() == nullptr)
-            return;
+        this->onTimeout();
+    });
 
-        this->position_ += gifFrameLength;
-        this->signal.invoke();
-        getApp()->windows->repaintGifEmotes();
+    QObject::connect(qApp, &QGuiApplication::focusWindowChanged, [this] {
+        this->pausedDirty_ = true;
+        this->resume();
+    });
+    QObject::connect(qApp, &QGuiApplication::applicationStateChanged, [this] {
+        this->pausedDirty_ = true;
+        this->resume();
     });
+
+    // shown windows are painted, which schedules their images again
+    qApp->installEventFilter(new WindowStateFilter(qApp, [this] {
+        this->pausedDirty_ = true;
+    }));
+}
+
+long unsigned GIFTimer::position()
+{
+    // position_ only moves while the timer runs. After an idle period it is
+    // brought up to date, otherwise images that start animating now would
+    // get deadlines in the past.
+    if (!this->advancing_ && !this->timer.isActive())
+    {
+        this->position_ = this->clock_.elapsed();
+    }
+
+    return this->position_;
+}
+
+void GIFTimer::scheduleAt(long unsigned deadline)
+{
+    if (this->paused())
+    {
+        return;
+    }
+
+    // many images share a deadline, e.g. the same emote in several messages
+    if (!this->scheduled_.insert(deadline).second)
+    {
+        return;
+    }
+
+    this->deadlines_.push(deadline);
+
+    if (this->deadlines_.top() == deadline)
+    {
+        this->startTimer();
+    }
+}
+
+bool GIFTimer::paused()
+{
+    if (this->pausedDirty_)
+    {
+        this->paused_ = this->shouldPause();
+        this->pausedDirty_ = false;
+    }
+
+    return this->paused_;
+}
+
+bool GIFTimer::shouldPause() const
+{
+    if (!getSettings()->animateEmotes)
+    {
+        return true;
+    }
+
+    if (getSettings()->animationsWhenFocused &&
+        qApp->activeWindow() == nullptr)
+    {
+        return true;
+    }
+
+    // all windows are minimized or hidden
+    auto widgets = QApplication::topLevelWidgets();
+    return std::none_of(widgets.begin(), widgets.end(), [](QWidget *widget) {
+        return widget->isVisible() && !widget->isMinimized();
+    });
+}
+
+void GIFTimer::onTimeout()
+{
+    if (this->paused())
+    {
+        // views are repainted (and reschedule their images) once we resume
+        this->clear();
+        return;
+    }
+
+    this->position_ = this->clock_.elapsed();
+
+    while (!this->deadlines_.empty() &&
+           this->deadlines_.top() <= this->position_)
+    {
+        this->scheduled_.erase(this->deadlines_.top());
+        this->deadlines_.pop();
+    }
+
+    this->advancing_ = true;
+    this->signal.invoke();
+    this->advancing_ = false;
+    getApp()->windows->repaintGifEmotes();
+
+    if (!this->deadlines_.empty())
+    {
+        this->startTimer();
+    }
+}
+
+void GIFTimer::resume()
+{
+    if (this->paused())
+    {
+        return;
+    }
+
+    // advance all images to the current position, painting them will
+    // schedule their next frame
+    this->position_ = this->clock_.elapsed();
+    this->advancing_ = true;
+    this->signal.invoke();
+    this->advancing_ = false;
+    getApp()->windows->repaintGifEmotes();
+}
+
+void GIFTimer::clear()
+{
+    this->timer.stop();
+    this->deadlines_ = {};
+    this->scheduled_.clear();
+}
+
+void GIFTimer::startTimer()
+{
+    auto now = static_cast<long unsigned>(this->clock_.elapsed());
+    auto next = this->deadlines_.top();
+
+    this->timer.start(next > now ? int(next - now) : 0);
 }
 
 }  // namespace chatterino
@@ -1,26 +1,59 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QTimer>
 #include <pajlada/signals/signal.hpp>
 
-namespace chatterino {
+#include <functional>
+#include <queue>
+#include <unordered_set>
+#include <vector>
 
-constexpr long unsigned gifFrameLength = 33;
+namespace chatterino {
 
+// Drives the animation of all animated images.
+//
+// Instead of ticking at a fixed rate, the timer keeps a min-heap of the
+// positions at which the animated images that were painted recently change
+// their frame. It only wakes up when one of those deadlines is reached, so it
+// stays idle when no animated image is visible.
 class GIFTimer
 {
 public:
     void initialize();
 
+    // Requests a wakeup once the animation position reaches `deadline` (in
+    // milliseconds). Ignored while animations are paused.
+    void scheduleAt(long unsigned deadline);
+
     pajlada::Signals::NoArgSignal signal;
-    long unsigned position()
-    {
-        return this->position_;
-    }
+    // The animation position in milliseconds. Images advanced by the same
+    // tick all see the same position.
+    long unsigned position();
 
 private:
+    // Returns true if animations should not advance right now, e.g. because
+    // no window is visible or, with "animationsWhenFocused", no window is
+    // focused. Cached until a window or a setting changes.
+    bool paused();
+    bool shouldPause() const;
+    void onTimeout();
+    void resume();
+    void clear();
+    void startTimer();
+
     QTimer timer;
+    QElapsedTimer clock_;
     long unsigned position_{};
+    // set while the images are advanced, so they share one position
+    bool advancing_ = false;
+    bool paused_ = false;
+    bool pausedDirty_ = true;
+
+    std::priority_queue<long unsigned, std::vector<long unsigned>,
+                        std::greater<long unsigned>>
+        deadlines_;
+    std::unordered_set<long unsigned> scheduled_;
 };
 
 }  // namespace chatterino
@@ -3,6 +3,7 @@
 #include "Application.hpp"
 #include "common/QLogging.hpp"
 #include "singletons/Settings.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 #include "singletons/Theme.hpp"
 #include "singletons/WindowManager.hpp"
 #include "widgets/helper/ChannelView.hpp"
@@ -12,13 +13,15 @@
 #include <QPainter>
 #include <QTimer>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #define MIN_THUMB_HEIGHT 10
 
 namespace chatterino {
 
-Scrollbar::Scrollbar(ChannelView *parent)
+Scrollbar::Scrollbar(QWidget *parent)
     : BaseWidget(parent)
     , currentValueAnimation_(this, "currentValue_")
 {
@@ -28,23 +31,38 @@ Scrollbar::Scrollbar(ChannelView *parent)
         QEasingCurve(QEasingCurve::OutCubic));
 
     setMouseTracking(true);
+
+    getSettings()->enableRedeemedHighlight.connect(
+        [this](auto, auto) {
+            this->invalidateMinimap();
+            this->update();
+        },
+        this->connections_);
 }
 
 void Scrollbar::addHighlight(ScrollbarHighlight highlight)
 {
     ScrollbarHighlight deleted;
-    this->highlights_.pushBack(highlight, deleted);
+    bool evicted = this->highlights_.pushBack(highlight, deleted);
+
+    auto length = this->minimapLength_ + (evicted ? 0 : 1);
+    this->updateMinimap(length - 1, length, evicted);
 }
 
 void Scrollbar::addHighlightsAtStart(
     const std::vector<ScrollbarHighlight> &_highlights)
 {
     this->highlights_.pushFront(_highlights);
+
+    // everything moved down, not worth doing incrementally
+    this->invalidateMinimap();
 }
 
 void Scrollbar::replaceHighlight(size_t index, ScrollbarHighlight replacement)
 {
     this->highlights_.replaceItem(index, replacement);
+
+    this->updateMinimap(index, this->minimapLength_, false);
 }
 
 void Scrollbar::pauseHighlights()
@@ -55,11 +73,13 @@ void Scrollbar::pauseHighlights()
 void Scrollbar::unpauseHighlights()
 {
     this->highlightsPaused_ = false;
+    this->invalidateMinimap();
 }
 
 void Scrollbar::clearHighlights()
 {
     this->highlights_.clear();
+    this->invalidateMinimap();
 }
 
 LimitedQueueSnapshot<ScrollbarHighlight> Scrollbar::getHighlightSnapshot()
@@ -250,8 +270,6 @@ void Scrollbar::paintEvent(QPaintEvent *)
     QPainter painter(this);
     painter.fillRect(rect(), this->theme->scrollbars.background);
 
-    bool enableRedeemedHighlights = getSettings()->enableRedeemedHighlight;
-
     //    painter.fillRect(QRect(xOffset, 0, width(), this->buttonHeight),
     //                     this->themeManager->ScrollbarArrow);
     //    painter.fillRect(QRect(xOffset, height() - this->buttonHeight,
@@ -281,15 +299,189 @@ void Scrollbar::paintEvent(QPaintEvent *)
         return;
     }
 
-    int w = this->width();
-    float y = 0;
-    float dY = float(this->height()) / float(snapshotLength);
-    int highlightHeight =
-        int(std::ceil(std::max<float>(this->scale() * 2, dY)));
+    // the colors of highlights can be changed in place from the settings,
+    // which invalidates all message buffers
+    if (this->minimapBufferGeneration_ !=
+        getApp()->windows->getBufferGeneration())
+    {
+        this->minimapBufferGeneration_ =
+            getApp()->windows->getBufferGeneration();
+        this->invalidateMinimap();
+    }
+
+    if (!this->minimapValid_ || this->minimapLength_ != snapshotLength ||
+        this->minimap_.width() != this->width() ||
+        this->minimapGeometry(snapshotLength) != this->minimapGeometry_)
+    {
+        this->rebuildMinimap(snapshot);
+    }
+
+    if (this->minimapValid_)
+    {
+        // no smooth transformation, scaling down must not blend highlights
+        // into the background
+        painter.drawImage(
+            this->rect(), this->minimap_,
+            QRect(0, 0, this->width(),
+                  int(snapshotLength) *
+                      this->minimapGeometry_.rowsPerHighlight));
+    }
+}
+
+bool Scrollbar::MinimapGeometry::operator==(const MinimapGeometry &other) const
+{
+    return this->rowsPerHighlight == other.rowsPerHighlight &&
+           this->defaultRows == other.defaultRows &&
+           this->lineRows == other.lineRows;
+}
+
+bool Scrollbar::MinimapGeometry::operator!=(const MinimapGeometry &other) const
+{
+    return !(*this == other);
+}
+
+Scrollbar::MinimapGeometry Scrollbar::minimapGeometry(
+    size_t highlightCount) const
+{
+    MinimapGeometry geometry;
+
+    if (highlightCount == 0 || this->height() <= 0)
+    {
+        return geometry;
+    }
+
+    auto height = float(this->height());
+    auto limit = std::max<size_t>(1, this->highlights_.limit());
+
+    // The geometry only changes when the count crosses a power of two, so a
+    // queue that is still filling up is drawn incrementally as well. The
+    // rows per highlight come from the limit and never change.
+    size_t bucket = 1;
+    while (bucket < highlightCount && bucket < limit)
+    {
+        bucket *= 2;
+    }
+    auto count = float(std::min(bucket, limit));
+
+    // at least one row per pixel, so lines are never thinner than a pixel
+    geometry.rowsPerHighlight =
+        std::max(1, int(std::ceil(height / float(limit))));
+
+    auto pixelsPerRow = height / (count * float(geometry.rowsPerHighlight));
+
+    geometry.defaultRows =
+        std::max(geometry.rowsPerHighlight,
+                 int(std::ceil(this->scale() * 2 / pixelsPerRow)));
+    geometry.lineRows = std::max(1, int(std::ceil(1 / pixelsPerRow)));
+
+    return geometry;
+}
+
+void Scrollbar::invalidateMinimap()
+{
+    this->minimapValid_ = false;
+}
+
+void Scrollbar::rebuildMinimap(
+    const LimitedQueueSnapshot<ScrollbarHighlight> &snapshot)
+{
+    auto length = snapshot.size();
+    auto geometry = this->minimapGeometry(length);
+    int rows = int(length) * geometry.rowsPerHighlight;
+
+    if (this->width() <= 0 || rows <= 0)
+    {
+        this->minimapValid_ = false;
+        return;
+    }
+
+    // room for a full queue, so appending highlights doesn't reallocate
+    auto capacity = std::max(
+        rows, int(this->highlights_.limit()) * geometry.rowsPerHighlight);
+    if (this->minimap_.width() != this->width() ||
+        this->minimap_.height() < capacity)
+    {
+        this->minimap_ = QImage(this->width(), capacity,
+                                QImage::Format_ARGB32_Premultiplied);
+    }
+
+    this->minimap_.fill(Qt::transparent);
+    this->minimapGeometry_ = geometry;
+    this->minimapLength_ = length;
+    this->minimapValid_ = true;
+
+    this->repaintMinimap(snapshot, 0, length - 1);
+}
+
+void Scrollbar::updateMinimap(size_t index, size_t length, bool evicted)
+{
+    if (!this->minimapValid_ || this->highlightsPaused_)
+    {
+        this->invalidateMinimap();
+        return;
+    }
+
+    auto snapshot = this->highlights_.getSnapshot();
+    auto rowsPerHighlight = this->minimapGeometry_.rowsPerHighlight;
+
+    if (snapshot.size() != length || index >= length ||
+        this->minimapGeometry(length) != this->minimapGeometry_ ||
+        int(length) * rowsPerHighlight > this->minimap_.height())
+    {
+        this->invalidateMinimap();
+        return;
+    }
+
+    if (evicted)
+    {
+        // the first highlight was removed, move all others up by one
+        auto bytesPerLine = size_t(this->minimap_.bytesPerLine());
+        auto shift = size_t(rowsPerHighlight) * bytesPerLine;
+        auto *bits = this->minimap_.bits();
+
+        std::memmove(bits, bits + shift,
+                     length * size_t(rowsPerHighlight) * bytesPerLine - shift);
+    }
+
+    this->minimapLength_ = length;
+    this->repaintMinimap(snapshot, index, index);
+}
+
+void Scrollbar::repaintMinimap(
+    const LimitedQueueSnapshot<ScrollbarHighlight> &snapshot, size_t first,
+    size_t last)
+{
+    const auto &geometry = this->minimapGeometry_;
+    int rowsPerHighlight = geometry.rowsPerHighlight;
+    int extent = std::max(geometry.defaultRows, geometry.lineRows);
+    int end = int(this->minimapLength_) * rowsPerHighlight;
+    int w = this->minimap_.width();
 
-    for (size_t i = 0; i < snapshotLength; i++)
+    int top = int(first) * rowsPerHighlight;
+    int bottom = std::min(end, int(last) * rowsPerHighlight + extent);
+
+    if (top >= bottom)
+    {
+        return;
+    }
+
+    QPainter painter(&this->minimap_);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(0, top, w, bottom - top, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setClipRect(0, top, w, bottom - top);
+
+    bool enableRedeemedHighlights =
+        SettingsSnapshot::current()->enableRedeemedHighlight;
+
+    // highlights above `first` can reach into the repainted rows
+    auto i = size_t(std::max(0, top - extent + 1) / rowsPerHighlight);
+
+    for (; i < this->minimapLength_ && int(i) * rowsPerHighlight < bottom;
+         i++)
     {
         ScrollbarHighlight const &highlight = snapshot[i];
+        int y = int(i) * rowsPerHighlight;
 
         if (!highlight.isNull())
         {
@@ -301,13 +493,13 @@ void Scrollbar::paintEvent(QPaintEvent *)
                 switch (highlight.getStyle())
                 {
                     case ScrollbarHighlight::Default: {
-                        painter.fillRect(w / 8 * 3, int(y), w / 4,
-                                         highlightHeight, color);
+                        painter.fillRect(w / 8 * 3, y, w / 4,
+                                         geometry.defaultRows, color);
                     }
                     break;
 
                     case ScrollbarHighlight::Line: {
-                        painter.fillRect(0, int(y), w, 1, color);
+                        painter.fillRect(0, y, w, geometry.lineRows, color);
                     }
                     break;
 
@@ -315,8 +507,6 @@ void Scrollbar::paintEvent(QPaintEvent *)
                 }
             }
         }
-
-        y += dY;
     }
 }
 
@@ -4,6 +4,7 @@
 #include "widgets/BaseWidget.hpp"
 #include "widgets/helper/ScrollbarHighlight.hpp"
 
+#include <QImage>
 #include <QMutex>
 #include <QPropertyAnimation>
 #include <QWidget>
@@ -18,7 +19,7 @@ class Scrollbar : public BaseWidget
     Q_OBJECT
 
 public:
-    Scrollbar(ChannelView *parent = nullptr);
+    Scrollbar(QWidget *parent = nullptr);
 
     void addHighlight(ScrollbarHighlight highlight);
     void addHighlightsAtStart(
@@ -70,6 +71,34 @@ private:
     LimitedQueueSnapshot<ScrollbarHighlight> getHighlightSnapshot();
     void updateScroll();
 
+    // The highlights are drawn into minimap_ with a fixed number of rows per
+    // highlight, which is then scaled to the height of the scrollbar when
+    // painting. That way adding, evicting or replacing a highlight only has
+    // to touch the rows of that highlight.
+    struct MinimapGeometry {
+        int rowsPerHighlight = 1;
+        // rows covered by a highlight of the given style, can be more than
+        // rowsPerHighlight so highlights stay visible when scaled down
+        int defaultRows = 1;
+        int lineRows = 1;
+
+        bool operator==(const MinimapGeometry &other) const;
+        bool operator!=(const MinimapGeometry &other) const;
+    };
+
+    MinimapGeometry minimapGeometry(size_t highlightCount) const;
+    void invalidateMinimap();
+    void rebuildMinimap(
+        const LimitedQueueSnapshot<ScrollbarHighlight> &snapshot);
+    // Called after the highlight at `index` was appended or replaced, with
+    // `length` being the expected number of highlights afterwards. Repaints
+    // the rows of that highlight, or invalidates the minimap if it can't be
+    // updated incrementally.
+    void updateMinimap(size_t index, size_t length, bool evicted);
+    void repaintMinimap(
+        const LimitedQueueSnapshot<ScrollbarHighlight> &snapshot, size_t first,
+        size_t last);
+
     QMutex mutex_;
 
     QPropertyAnimation currentValueAnimation_;
@@ -78,6 +107,13 @@ private:
     bool highlightsPaused_{false};
     LimitedQueueSnapshot<ScrollbarHighlight> highlightSnapshot_;
 
+    QImage minimap_;
+    bool minimapValid_{false};
+    // number of highlights drawn into minimap_
+    size_t minimapLength_{0};
+    MinimapGeometry minimapGeometry_;
+    int minimapBufferGeneration_{-1};
+
     bool atBottom_{false};
 
     int mouseOverIndex_ = -1;
@@ -99,6 +135,8 @@ private:
 
     pajlada::Signals::NoArgSignal currentValueChanged_;
     pajlada::Signals::NoArgSignal desiredValueChanged_;
+
+    std::vector<pajlada::Signals::ScopedConnection> connections_;
 };
 
 }  // namespace chatterino
@@ -4,44 +4,26 @@
 #include "common/CompletionModel.hpp"
 #include "controllers/accounts/AccountController.hpp"
 #include "debug/Benchmark.hpp"
-#include "messages/Message.hpp"
-#include "messages/MessageBuilder.hpp"
+#include "messages/Emote.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
 #include "singletons/Emotes.hpp"
 #include "singletons/WindowManager.hpp"
 #include "util/Shortcut.hpp"
 #include "widgets/Notebook.hpp"
 #include "widgets/Scrollbar.hpp"
-#include "widgets/helper/ChannelView.hpp"
+#include "widgets/helper/EmoteGridView.hpp"
 
 #include <QHBoxLayout>
+#include <QLineEdit>
 #include <QShortcut>
 #include <QTabWidget>
 
 namespace chatterino {
 namespace {
-    auto makeTitleMessage(const QString &title)
-    {
-        MessageBuilder builder;
-        builder.emplace<TextElement>(title, MessageElementFlag::Text);
-        builder->flags.set(MessageFlag::Centered);
-        return builder.release();
-    }
-    auto makeEmoteMessage(const EmoteMap &map,
-                          const MessageElementFlag &emoteFlag)
-    {
-        MessageBuilder builder;
-        builder->flags.set(MessageFlag::Centered);
-        builder->flags.set(MessageFlag::DisableCompactEmotes);
-
-        if (map.empty())
-        {
-            builder.emplace<TextElement>("no emotes available",
-                                         MessageElementFlag::Text,
-                                         MessageColor::System);
-            return builder.release();
-        }
+    using Section = EmoteGridView::Section;
 
+    Section makeEmoteSection(const QString &title, const EmoteMap &map)
+    {
         std::vector<std::pair<EmoteName, EmotePtr>> vec(map.begin(), map.end());
         std::sort(vec.begin(), vec.end(),
                   [](const std::pair<EmoteName, EmotePtr> &l,
@@ -49,23 +31,24 @@ namespace {
                       return CompletionModel::compareStrings(l.first.string,
                                                              r.first.string);
                   });
+
+        Section section{title, {}};
+        section.items.reserve(vec.size());
         for (const auto &emote : vec)
         {
-            builder
-                .emplace<EmoteElement>(
-                    emote.second,
-                    MessageElementFlags{MessageElementFlag::AlwaysShow,
-                                        emoteFlag})
-                ->setLink(Link(Link::InsertText, emote.first.string));
+            section.items.push_back(
+                {emote.second, Link(Link::InsertText, emote.first.string)});
         }
 
-        return builder.release();
+        return section;
     }
     void addEmoteSets(
         std::vector<std::shared_ptr<TwitchAccount::EmoteSet>> sets,
-        Channel &globalChannel, Channel &subChannel, QString currentChannelName)
+        std::vector<Section> &globalSections,
+        std::vector<Section> &subSections, QString currentChannelName)
     {
-        QMap<QString, QPair<bool, std::vector<MessagePtr>>> mapOfSets;
+        // channel name -> (is global, sections of that channel)
+        QMap<QString, QPair<bool, std::vector<Section>>> mapOfSets;
 
         for (const auto &set : sets)
         {
@@ -73,49 +56,45 @@ namespace {
             auto channelName = set->channelName;
             auto text = set->text.isEmpty() ? "Twitch" : set->text;
 
-            // EMOTES
-            MessageBuilder builder;
-            builder->flags.set(MessageFlag::Centered);
-            builder->flags.set(MessageFlag::DisableCompactEmotes);
-
-            // If value of map is empty, create init pair and add title.
+            // If value of map is empty, create init pair.
             if (mapOfSets.find(channelName) == mapOfSets.end())
             {
-                std::vector<MessagePtr> b;
-                b.push_back(makeTitleMessage(text));
-                mapOfSets[channelName] = qMakePair(set->key == "0", b);
+                mapOfSets[channelName] =
+                    qMakePair(set->key == "0", std::vector<Section>{});
             }
 
-            for (const auto &emote : set->emotes)
+            // EMOTES
+            // all sets of a channel are shown under the title of the first one
+            auto &sections = mapOfSets[channelName].second;
+            if (sections.empty())
             {
-                builder
-                    .emplace<EmoteElement>(
-                        getApp()->emotes->twitch.getOrCreateEmote(emote.id,
-                                                                  emote.name),
-                        MessageElementFlags{MessageElementFlag::AlwaysShow,
-                                            MessageElementFlag::TwitchEmote})
-                    ->setLink(Link(Link::InsertText, emote.name.string));
+                // sets without emotes only showed their title
+                sections.push_back(Section{text, {}, {}});
             }
 
-            mapOfSets[channelName].second.push_back(builder.release());
+            for (const auto &emote : set->emotes)
+            {
+                sections.back().items.push_back(
+                    {getApp()->emotes->twitch.getOrCreateEmote(emote.id,
+                                                               emote.name),
+                     Link(Link::InsertText, emote.name.string)});
+            }
         }
 
-        // Output to channel all created messages,
-        // That contain title or emotes.
         // Put current channel emotes at the top
         auto currentChannelPair = mapOfSets[currentChannelName];
-        for (auto message : currentChannelPair.second)
+        for (auto &section : currentChannelPair.second)
         {
-            subChannel.addMessage(message);
+            subSections.push_back(std::move(section));
         }
         mapOfSets.remove(currentChannelName);
 
         foreach (auto pair, mapOfSets)
         {
-            auto &channel = pair.first ? globalChannel : subChannel;
-            for (auto message : pair.second)
+            auto &sections = pair.first ? globalSections : subSections;
+            for (auto &section : pair.second)
             {
-                channel.addMessage(message);
+                sections.push_back(std::move(section));
             }
         }
     }
@@ -130,6 +109,11 @@ EmotePopup::EmotePopup(QWidget *parent)
     auto layout = new QVBoxLayout(this);
     this->getLayoutContainer()->setLayout(layout);
 
+    auto search = new QLineEdit(this);
+    search->setPlaceholderText("Search emotes...");
+    search->setClearButtonEnabled(true);
+    layout->addWidget(search);
+
     auto notebook = new Notebook(this);
     layout->addWidget(notebook);
     layout->setMargin(0);
@@ -139,12 +123,8 @@ EmotePopup::EmotePopup(QWidget *parent)
     };
 
     auto makeView = [&](QString tabTitle) {
-        auto view = new ChannelView();
+        auto view = new EmoteGridView();
 
-        view->setOverrideFlags(MessageElementFlags{
-            MessageElementFlag::Default, MessageElementFlag::AlwaysShow,
-            MessageElementFlag::EmoteImages});
-        view->setEnableScrollingToBottom(false);
         notebook->addPage(view, tabTitle);
         view->linkClicked.connect(clicked);
 
@@ -156,6 +136,14 @@ EmotePopup::EmotePopup(QWidget *parent)
     this->globalEmotesView_ = makeView("Global");
     this->viewEmojis_ = makeView("Emojis");
 
+    QObject::connect(search, &QLineEdit::textChanged,
+                     [this](const QString &text) {
+                         for (auto *view : this->views())
+                         {
+                             view->setFilter(text);
+                         }
+                     });
+
     this->loadEmojis();
 
     // CTRL + 1-8 to open corresponding tab
@@ -184,13 +172,13 @@ EmotePopup::EmotePopup(QWidget *parent)
     // Scroll with Page Up / Page Down
     createWindowShortcut(this, "PgUp", [=] {
         auto &scrollbar =
-            dynamic_cast<ChannelView *>(notebook->getSelectedPage())
+            dynamic_cast<EmoteGridView *>(notebook->getSelectedPage())
                 ->getScrollBar();
         scrollbar.offset(-scrollbar.getLargeChange());
     });
     createWindowShortcut(this, "PgDown", [=] {
         auto &scrollbar =
-            dynamic_cast<ChannelView *>(notebook->getSelectedPage())
+            dynamic_cast<EmoteGridView *>(notebook->getSelectedPage())
                 ->getScrollBar();
         scrollbar.offset(scrollbar.getLargeChange());
     });
@@ -206,73 +194,58 @@ void EmotePopup::loadChannel(ChannelPtr _channel)
     if (twitchChannel == nullptr)
         return;
 
-    auto addEmotes = [&](Channel &channel, const EmoteMap &map,
-                         const QString &title,
-                         const MessageElementFlag &emoteFlag) {
-        channel.addMessage(makeTitleMessage(title));
-        channel.addMessage(makeEmoteMessage(map, emoteFlag));
-    };
-
-    auto subChannel = std::make_shared<Channel>("", Channel::Type::None);
-    auto globalChannel = std::make_shared<Channel>("", Channel::Type::None);
-    auto channelChannel = std::make_shared<Channel>("", Channel::Type::None);
+    std::vector<Section> subSections;
+    std::vector<Section> globalSections;
+    std::vector<Section> channelSections;
 
     // twitch
     addEmoteSets(
         getApp()->accounts->twitch.getCurrent()->accessEmotes()->emoteSets,
-        *globalChannel, *subChannel, _channel->getName());
+        globalSections, subSections, _channel->getName());
 
     // global
-    addEmotes(*globalChannel, *twitchChannel->globalBttv().emotes(),
-              "BetterTTV", MessageElementFlag::BttvEmote);
-    addEmotes(*globalChannel, *twitchChannel->globalFfz().emotes(),
-              "FrankerFaceZ", MessageElementFlag::FfzEmote);
+    globalSections.push_back(makeEmoteSection(
+        "BetterTTV", *twitchChannel->globalBttv().emotes()));
+    globalSections.push_back(makeEmoteSection(
+        "FrankerFaceZ", *twitchChannel->globalFfz().emotes()));
 
     // channel
-    addEmotes(*channelChannel, *twitchChannel->bttvEmotes(), "BetterTTV",
-              MessageElementFlag::BttvEmote);
-    addEmotes(*channelChannel, *twitchChannel->ffzEmotes(), "FrankerFaceZ",
-              MessageElementFlag::FfzEmote);
-
-    this->globalEmotesView_->setChannel(globalChannel);
-    this->subEmotesView_->setChannel(subChannel);
-    this->channelEmotesView_->setChannel(channelChannel);
+    channelSections.push_back(
+        makeEmoteSection("BetterTTV", *twitchChannel->bttvEmotes()));
+    channelSections.push_back(
+        makeEmoteSection("FrankerFaceZ", *twitchChannel->ffzEmotes()));
 
-    if (subChannel->getMessageSnapshot().size() == 0)
+    if (subSections.empty())
     {
-        MessageBuilder builder;
-        builder->flags.set(MessageFlag::Centered);
-        builder->flags.set(MessageFlag::DisableCompactEmotes);
-        builder.emplace<TextElement>("no subscription emotes available",
-                                     MessageElementFlag::Text,
-                                     MessageColor::System);
-        subChannel->addMessage(builder.release());
+        subSections.push_back(
+            Section{{}, {}, "no subscription emotes available"});
     }
+
+    this->globalEmotesView_->setSections(std::move(globalSections));
+    this->subEmotesView_->setSections(std::move(subSections));
+    this->channelEmotesView_->setSections(std::move(channelSections));
 }
 
 void EmotePopup::loadEmojis()
 {
     auto &emojis = getApp()->emotes->emojis.emojis;
 
-    ChannelPtr emojiChannel(new Channel("", Channel::Type::None));
-
-    // emojis
-    MessageBuilder builder;
-    builder->flags.set(MessageFlag::Centered);
-    builder->flags.set(MessageFlag::DisableCompactEmotes);
-
-    emojis.each([&builder](const auto &key, const auto &value) {
-        builder
-            .emplace<EmoteElement>(
-                value->emote,
-                MessageElementFlags{MessageElementFlag::AlwaysShow,
-                                    MessageElementFlag::EmojiAll})
-            ->setLink(
-                Link(Link::Type::InsertText, ":" + value->shortCodes[0] + ":"));
+    Section section{"Emojis", {}};
+    emojis.each([&section](const auto &key, const auto &value) {
+        section.items.push_back(
+            {value->emote, Link(Link::Type::InsertText,
+                                ":" + value->shortCodes[0] + ":")});
     });
-    emojiChannel->addMessage(builder.release());
 
-    this->viewEmojis_->setChannel(emojiChannel);
+    std::vector<Section> sections;
+    sections.push_back(std::move(section));
+    this->viewEmojis_->setSections(std::move(sections));
+}
+
+std::vector<EmoteGridView *> EmotePopup::views() const
+{
+    return {this->subEmotesView_, this->channelEmotesView_,
+            this->globalEmotesView_, this->viewEmojis_};
 }
 
 void EmotePopup::closeEvent(QCloseEvent *event)
@@ -7,7 +7,7 @@
 namespace chatterino {
 
 struct Link;
-class ChannelView;
+class EmoteGridView;
 class Channel;
 using ChannelPtr = std::shared_ptr<Channel>;
 
@@ -24,10 +24,12 @@ public:
     pajlada::Signals::Signal<Link> linkClicked;
 
 private:
-    ChannelView *globalEmotesView_{};
-    ChannelView *channelEmotesView_{};
-    ChannelView *subEmotesView_{};
-    ChannelView *viewEmojis_{};
+    std::vector<EmoteGridView *> views() const;
+
+    EmoteGridView *globalEmotesView_{};
+    EmoteGridView *channelEmotesView_{};
+    EmoteGridView *subEmotesView_{};
+    EmoteGridView *viewEmojis_{};
 };
 
 }  // namespace chatterino
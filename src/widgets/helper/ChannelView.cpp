@@ -4,6 +4,7 @@
 #include <QDate>
 #include <QDebug>
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QGraphicsBlurEffect>
 #include <QMessageBox>
 #include <QPainter>
@@ -20,6 +21,7 @@
 #include "controllers/accounts/AccountController.hpp"
 #include "controllers/commands/CommandController.hpp"
 #include "debug/Benchmark.hpp"
+#include "debug/FrameStats.hpp"
 #include "messages/Emote.hpp"
 #include "messages/LimitedQueueSnapshot.hpp"
 #include "messages/Message.hpp"
@@ -32,6 +34,7 @@
 #include "providers/twitch/TwitchIrcServer.hpp"
 #include "singletons/Resources.hpp"
 #include "singletons/Settings.hpp"
+#include "singletons/SettingsSnapshot.hpp"
 #include "singletons/Theme.hpp"
 #include "singletons/TooltipPreviewImage.hpp"
 #include "singletons/WindowManager.hpp"
@@ -52,6 +55,10 @@
 #define DRAW_WIDTH (this->width())
 #define SELECTION_RESUME_SCROLLING_MSG_THRESHOLD 3
 #define CHAT_HOVER_PAUSE_DURATION 1000
+#define SUSPEND_DELAY 10000
+#define PENDING_APPENDS_DELAY 16
+// paints closer together than this belong to the same frame
+#define FRAME_INTERVAL 12
 
 namespace chatterino {
 namespace {
@@ -123,6 +130,7 @@ namespace {
 
 ChannelView::ChannelView(BaseWidget *parent)
     : BaseWidget(parent)
+    , frameStats_(FrameStats::create())
     , scrollBar_(new Scrollbar(this))
 {
     this->setMouseTracking(true);
@@ -157,6 +165,38 @@ ChannelView::ChannelView(BaseWidget *parent)
     QObject::connect(&this->scrollTimer_, &QTimer::timeout, this,
                      &ChannelView::scrollUpdateRequested);
 
+    this->suspendTimer_.setSingleShot(true);
+    this->suspendTimer_.setInterval(SUSPEND_DELAY);
+    QObject::connect(&this->suspendTimer_, &QTimer::timeout, this, [this] {
+        this->suspend();
+    });
+    // views in tabs that are never opened are suspended as well
+    this->hidden_ = !this->isVisible();
+    if (this->hidden_)
+    {
+        this->suspendTimer_.start();
+    }
+
+    this->pendingAppendsTimer_.setSingleShot(true);
+    this->pendingAppendsTimer_.setInterval(PENDING_APPENDS_DELAY);
+    QObject::connect(&this->pendingAppendsTimer_, &QTimer::timeout, this,
+                     [this] {
+                         this->flushPendingAppends();
+                     });
+    QObject::connect(&this->scrollBar_->getCurrentValueAnimation(),
+                     &QAbstractAnimation::stateChanged, this,
+                     [this](QAbstractAnimation::State state) {
+                         // flushing moves the scrollbar, which would restart
+                         // the animation from inside its own state change
+                         if (state == QAbstractAnimation::Stopped &&
+                             !this->pendingAppends_.empty())
+                         {
+                             QTimer::singleShot(0, this, [this] {
+                                 this->flushPendingAppends();
+                             });
+                         }
+                     });
+
     this->setFocusPolicy(Qt::FocusPolicy::StrongFocus);
 }
 
@@ -199,7 +239,11 @@ void ChannelView::initializeSignals()
         this->connections_);
 
     connections_.push_back(getApp()->windows->gifRepaintRequested.connect([&] {
-        this->queueUpdate();
+        if (!this->hidden_)
+        {
+            this->animationUpdateQueued_ = true;
+            this->queueUpdate();
+        }
     }));
 
     connections_.push_back(
@@ -381,6 +425,16 @@ void ChannelView::performLayout(bool causedByScrollbar)
 {
     // BenchmarkGuard benchmark("layout");
 
+    // hidden views are laid out once they are shown again
+    if (this->checkHidden())
+    {
+        this->layoutPending_ = true;
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
     /// Get messages and check if there are at least 1
     auto messages = this->getMessagesSnapshot();
 
@@ -388,22 +442,26 @@ void ChannelView::performLayout(bool causedByScrollbar)
         this->scrollBar_->isAtBottom() || !this->scrollBar_->isVisible();
 
     /// Layout visible messages
-    this->layoutVisibleMessages(messages);
+    auto messagesLaidOut = this->layoutVisibleMessages(messages);
 
     /// Update scrollbar
     this->updateScrollbar(messages, causedByScrollbar);
 
+    this->frameStats_->addLayout(double(timer.nsecsElapsed()) / 1000000.0,
+                                 messagesLaidOut);
+
     this->goToBottom_->setVisible(this->enableScrollingToBottom_ &&
                                   this->scrollBar_->isVisible() &&
                                   !this->scrollBar_->isAtBottom());
 }
 
-void ChannelView::layoutVisibleMessages(
+int ChannelView::layoutVisibleMessages(
     LimitedQueueSnapshot<MessageLayoutPtr> &messages)
 {
     const auto start = size_t(this->scrollBar_->getCurrentValue());
     const auto layoutWidth = this->getLayoutWidth();
     const auto flags = this->getFlags();
+    auto messagesLaidOut = 0;
     auto redrawRequired = false;
 
     if (messages.size() > start)
@@ -414,16 +472,25 @@ void ChannelView::layoutVisibleMessages(
         for (auto i = start; i < messages.size() && y <= this->height(); i++)
         {
             auto message = messages[i];
+            auto layoutCount = message->getLayoutCount();
 
             redrawRequired |=
                 message->layout(layoutWidth, this->scale(), flags);
 
+            // messages whose buffer was only invalidated aren't counted
+            if (message->getLayoutCount() != layoutCount)
+            {
+                messagesLaidOut++;
+            }
+
             y += message->getHeight();
         }
     }
 
     if (redrawRequired)
         this->queueUpdate();
+
+    return messagesLaidOut;
 }
 
 void ChannelView::updateScrollbar(
@@ -486,6 +553,8 @@ void ChannelView::updateScrollbar(
 void ChannelView::clearMessages()
 {
     // Clear all stored messages in this chat widget
+    this->pendingAppends_.clear();
+    this->pendingAppendsTimer_.stop();
     this->messages_.clear();
     this->scrollBar_->clearHighlights();
     this->queueLayout();
@@ -593,6 +662,7 @@ void ChannelView::setChannel(ChannelPtr underlyingChannel)
     /// make copy of channel and expose
     this->channel_ = std::make_unique<Channel>(underlyingChannel->getName(),
                                                underlyingChannel->getType());
+    this->frameStats_->setName(underlyingChannel->getName());
 
     //
     // Proxy channel connections
@@ -702,7 +772,7 @@ void ChannelView::setChannel(ChannelPtr underlyingChannel)
         }
 
         this->messages_.pushBack(MessageLayoutPtr(messageLayout), deleted);
-        if (this->showScrollbarHighlights())
+        if (this->showScrollbarHighlights() && !this->suspended_)
         {
             this->scrollBar_->addHighlight(
                 snapshot[i]->getScrollBarHighlight());
@@ -776,14 +846,15 @@ bool ChannelView::hasSourceChannel() const
 void ChannelView::messageAppended(MessagePtr &message,
                                   boost::optional<MessageFlags> overridingFlags)
 {
-    MessageLayoutPtr deleted;
-
     auto *messageFlags = &message->flags;
     if (overridingFlags)
     {
         messageFlags = overridingFlags.get_ptr();
     }
 
+    // starts suspending views that were never shown
+    this->checkHidden();
+
     auto messageRef = new MessageLayout(message);
 
     if (this->lastMessageHasAlternateBackground_)
@@ -797,33 +868,24 @@ void ChannelView::messageAppended(MessagePtr &message,
     this->lastMessageHasAlternateBackground_ =
         !this->lastMessageHasAlternateBackground_;
 
-    if (!this->scrollBar_->isAtBottom() &&
-        this->scrollBar_->getCurrentValueAnimation().state() ==
-            QPropertyAnimation::Running)
+    // moving the scrollbar while it animates makes it jump around, so wait
+    // for the animation to stop, but at most until the next frame
+    if (!this->pendingAppends_.empty() ||
+        (!this->scrollBar_->isAtBottom() &&
+         this->scrollBar_->getCurrentValueAnimation().state() ==
+             QPropertyAnimation::Running))
     {
-        QEventLoop loop;
-
-        connect(&this->scrollBar_->getCurrentValueAnimation(),
-                &QAbstractAnimation::stateChanged, &loop, &QEventLoop::quit);
-
-        loop.exec();
-    }
+        this->pendingAppends_.push_back(MessageLayoutPtr(messageRef));
 
-    if (this->messages_.pushBack(MessageLayoutPtr(messageRef), deleted))
-    {
-        if (this->paused())
+        if (!this->pendingAppendsTimer_.isActive())
         {
-            if (!this->scrollBar_->isAtBottom())
-                this->pauseScrollOffset_--;
-        }
-        else
-        {
-            if (this->scrollBar_->isAtBottom())
-                this->scrollBar_->scrollToBottom();
-            else
-                this->scrollBar_->offset(-1);
+            this->pendingAppendsTimer_.start();
         }
     }
+    else
+    {
+        this->appendLayouts({MessageLayoutPtr(messageRef)});
+    }
 
     if (!messageFlags->has(MessageFlag::DoNotTriggerNotification))
     {
@@ -841,18 +903,66 @@ void ChannelView::messageAppended(MessagePtr &message,
             this->tabHighlightRequested.invoke(HighlightState::NewMessage);
         }
     }
+}
 
-    if (this->showScrollbarHighlights())
+void ChannelView::appendLayouts(const std::vector<MessageLayoutPtr> &layouts)
+{
+    MessageLayoutPtr deleted;
+    auto removed = 0;
+
+    for (auto &layout : layouts)
     {
-        this->scrollBar_->addHighlight(message->getScrollBarHighlight());
+        if (this->messages_.pushBack(layout, deleted))
+        {
+            removed++;
+        }
+
+        if (this->showScrollbarHighlights() && !this->suspended_)
+        {
+            this->scrollBar_->addHighlight(
+                layout->getMessage()->getScrollBarHighlight());
+        }
+    }
+
+    if (removed > 0)
+    {
+        if (this->paused())
+        {
+            if (!this->scrollBar_->isAtBottom())
+                this->pauseScrollOffset_ -= removed;
+        }
+        else
+        {
+            if (this->scrollBar_->isAtBottom())
+                this->scrollBar_->scrollToBottom();
+            else
+                this->scrollBar_->offset(-removed);
+        }
     }
 
     this->messageWasAdded_ = true;
     this->queueLayout();
 }
 
+void ChannelView::flushPendingAppends()
+{
+    this->pendingAppendsTimer_.stop();
+
+    if (this->pendingAppends_.empty())
+    {
+        return;
+    }
+
+    auto layouts = std::move(this->pendingAppends_);
+    this->pendingAppends_.clear();
+
+    this->appendLayouts(layouts);
+}
+
 void ChannelView::messageAddedAtStart(std::vector<MessagePtr> &messages)
 {
+    this->flushPendingAppends();
+
     std::vector<MessageLayoutPtr> messageRefs;
     messageRefs.resize(messages.size());
 
@@ -880,7 +990,7 @@ void ChannelView::messageAddedAtStart(std::vector<MessagePtr> &messages)
             this->scrollBar_->offset(qreal(messages.size()));
     }
 
-    if (this->showScrollbarHighlights())
+    if (this->showScrollbarHighlights() && !this->suspended_)
     {
         std::vector<ScrollbarHighlight> highlights;
         highlights.reserve(messages.size());
@@ -898,6 +1008,8 @@ void ChannelView::messageAddedAtStart(std::vector<MessagePtr> &messages)
 
 void ChannelView::messageRemoveFromStart(MessagePtr &message)
 {
+    this->flushPendingAppends();
+
     if (this->paused())
     {
         this->pauseSelectionOffset_ += 1;
@@ -915,6 +1027,9 @@ void ChannelView::messageRemoveFromStart(MessagePtr &message)
 
 void ChannelView::messageReplaced(size_t index, MessagePtr &replacement)
 {
+    // the index refers to the channel, which already has the pending messages
+    this->flushPendingAppends();
+
     if (index >= this->messages_.getSnapshot().size())
     {
         return;
@@ -936,8 +1051,11 @@ void ChannelView::messageReplaced(size_t index, MessagePtr &replacement)
         newItem->flags.set(MessageLayoutFlag::AlternateBackground);
     }
 
-    this->scrollBar_->replaceHighlight(index,
-                                       replacement->getScrollBarHighlight());
+    if (!this->suspended_)
+    {
+        this->scrollBar_->replaceHighlight(
+            index, replacement->getScrollBarHighlight());
+    }
 
     this->messages_.replaceItem(message, newItem);
     this->queueLayout();
@@ -1032,14 +1150,23 @@ MessageElementFlags ChannelView::getFlags() const
 
 void ChannelView::paintEvent(QPaintEvent * /*event*/)
 {
-    //    BenchmarkGuard benchmark("paint");
+    QElapsedTimer timer;
+    timer.start();
+
+    // partial updates can paint several times per frame
+    if (!this->frameClock_.isValid() ||
+        this->frameClock_.elapsed() >= FRAME_INTERVAL)
+    {
+        this->frameClock_.start();
+        this->frame_++;
+    }
 
     QPainter painter(this);
 
     painter.fillRect(rect(), this->theme->splits.background);
 
     // draw messages
-    this->drawMessages(painter);
+    auto buffersRebuilt = this->drawMessages(painter);
 
     // draw paused sign
     if (this->paused())
@@ -1049,11 +1176,15 @@ void ChannelView::paintEvent(QPaintEvent * /*event*/)
         painter.fillRect(QRectF(5, a / 4, a / 4, a), brush);
         painter.fillRect(QRectF(15, a / 4, a / 4, a), brush);
     }
+
+    this->frameStats_->addPaint(double(timer.nsecsElapsed()) / 1000000.0,
+                                buffersRebuilt, this->animationUpdateQueued_);
+    this->animationUpdateQueued_ = false;
 }
 
 // if overlays is false then it draws the message, if true then it draws things
 // such as the grey overlay when a message is disabled
-void ChannelView::drawMessages(QPainter &painter)
+int ChannelView::drawMessages(QPainter &painter)
 {
     auto messagesSnapshot = this->getMessagesSnapshot();
 
@@ -1061,7 +1192,7 @@ void ChannelView::drawMessages(QPainter &painter)
 
     if (start >= messagesSnapshot.size())
     {
-        return;
+        return 0;
     }
 
     int y = int(-(messagesSnapshot[start].get()->getHeight() *
@@ -1073,19 +1204,25 @@ void ChannelView::drawMessages(QPainter &painter)
     auto app = getApp();
     bool isMentions =
         this->underlyingChannel_ == app->twitch.server->mentionsChannel;
+    auto buffersRebuilt = 0;
+    auto settings = SettingsSnapshot::current();
 
     for (size_t i = start; i < messagesSnapshot.size(); ++i)
     {
         MessageLayout *layout = messagesSnapshot[i].get();
 
         bool isLastMessage = false;
-        if (getSettings()->showLastMessageIndicator)
+        if (settings->showLastMessageIndicator)
         {
             isLastMessage = this->lastReadMessage_.get() == layout;
         }
 
-        layout->paint(painter, DRAW_WIDTH, y, i, this->selection_,
-                      isLastMessage, windowFocused, isMentions);
+        if (layout->paint(painter, DRAW_WIDTH, y, i, this->selection_,
+                          isLastMessage, windowFocused, isMentions,
+                          *settings, this->frame_))
+        {
+            buffersRebuilt++;
+        }
 
         y += layout->getHeight();
 
@@ -1098,7 +1235,7 @@ void ChannelView::drawMessages(QPainter &painter)
 
     if (end == nullptr)
     {
-        return;
+        return buffersRebuilt;
     }
 
     // remove messages that are on screen
@@ -1132,6 +1269,8 @@ void ChannelView::drawMessages(QPainter &painter)
             break;
         }
     }
+
+    return buffersRebuilt;
 }
 
 void ChannelView::wheelEvent(QWheelEvent *event)
@@ -2013,14 +2152,73 @@ void ChannelView::mouseDoubleClickEvent(QMouseEvent *event)
     }
 }
 
+bool ChannelView::checkHidden()
+{
+    if (!this->hidden_ && !this->isVisible())
+    {
+        this->hidden_ = true;
+        this->suspendTimer_.start();
+    }
+
+    return this->hidden_;
+}
+
 void ChannelView::hideEvent(QHideEvent *)
 {
-    for (auto &layout : this->messagesOnScreen_)
+    this->hidden_ = true;
+
+    // keep everything around for a bit in case we're shown again right away,
+    // e.g. when switching between two tabs
+    this->suspendTimer_.start();
+}
+
+void ChannelView::showEvent(QShowEvent *)
+{
+    this->hidden_ = false;
+    this->suspendTimer_.stop();
+
+    if (this->suspended_)
+    {
+        this->resume();
+    }
+
+    if (this->layoutPending_)
+    {
+        this->layoutPending_ = false;
+        this->performLayout();
+    }
+}
+
+void ChannelView::suspend()
+{
+    this->suspended_ = true;
+    this->layoutPending_ = true;
+
+    auto snapshot = this->messages_.getSnapshot();
+    for (size_t i = 0; i < snapshot.size(); i++)
     {
-        layout->deleteBuffer();
+        snapshot[i]->deleteCache();
     }
 
     this->messagesOnScreen_.clear();
+    this->scrollBar_->clearHighlights();
+}
+
+void ChannelView::resume()
+{
+    this->suspended_ = false;
+
+    if (this->channel_ == nullptr || !this->showScrollbarHighlights())
+    {
+        return;
+    }
+
+    auto snapshot = this->messages_.getSnapshot();
+    for (size_t i = 0; i < snapshot.size(); i++)
+    {
+        this->scrollBar_->addHighlight(
+            snapshot[i]->getMessage()->getScrollBarHighlight());
+    }
 }
 
 void ChannelView::showUserInfoPopup(const QString &userName)
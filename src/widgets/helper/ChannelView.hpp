@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QPaintEvent>
 #include <QScroller>
 #include <QTimer>
@@ -39,6 +40,7 @@ class Scrollbar;
 class EffectLabel;
 struct Link;
 class MessageLayoutElement;
+class ViewFrameStats;
 
 enum class PauseReason {
     Mouse,
@@ -116,6 +118,7 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent *event) override;
 
     void hideEvent(QHideEvent *) override;
+    void showEvent(QShowEvent *) override;
 
     void handleLinkClick(QMouseEvent *event, const Link &link,
                          MessageLayout *layout);
@@ -133,14 +136,19 @@ private:
     void messageAddedAtStart(std::vector<MessagePtr> &messages);
     void messageRemoveFromStart(MessagePtr &message);
     void messageReplaced(size_t index, MessagePtr &replacement);
+    // Adds the layouts to the end of the view and moves the scrollbar once
+    // for all of them
+    void appendLayouts(const std::vector<MessageLayoutPtr> &layouts);
+    void flushPendingAppends();
 
     void performLayout(bool causedByScollbar = false);
-    void layoutVisibleMessages(
-        LimitedQueueSnapshot<MessageLayoutPtr> &messages);
+    // Returns the number of messages that had to be laid out again
+    int layoutVisibleMessages(LimitedQueueSnapshot<MessageLayoutPtr> &messages);
     void updateScrollbar(LimitedQueueSnapshot<MessageLayoutPtr> &messages,
                          bool causedByScrollbar);
 
-    void drawMessages(QPainter &painter);
+    // Returns the number of messages whose elements had to be drawn again
+    int drawMessages(QPainter &painter);
     void setSelection(const SelectionItem &start, const SelectionItem &end);
     MessageElementFlags getFlags() const;
     void selectWholeMessage(MessageLayout *layout, int &messageIndex);
@@ -160,11 +168,40 @@ private:
     void enableScrolling(const QPointF &scrollStart);
     void disableScrolling();
 
+    // Returns true if the view isn't shown. Views that were never shown don't
+    // get a hide event, so their visibility is checked as well.
+    bool checkHidden();
+    // Drops the layouts, buffers and scrollbar highlights of all messages
+    void suspend();
+    // Rebuilds the scrollbar highlights, layouts are rebuilt lazily
+    void resume();
+
     QTimer *layoutCooldown_;
     bool layoutQueued_;
 
     QTimer updateTimer_;
     bool updateQueued_ = false;
+
+    // Views that aren't shown (e.g. on other tabs or in minimized windows)
+    // don't lay out their messages. When they stay hidden for a while they
+    // are suspended and only keep the messages themselves.
+    bool hidden_ = true;
+    bool suspended_ = false;
+    bool layoutPending_ = false;
+    QTimer suspendTimer_;
+
+    // Messages that arrive while the scrollbar animates are collected here and
+    // appended together once the animation stopped or with the next frame.
+    std::vector<MessageLayoutPtr> pendingAppends_;
+    QTimer pendingAppendsTimer_;
+
+    // paint and layout timings for the debug popup
+    std::shared_ptr<ViewFrameStats> frameStats_;
+    // counts frames rather than paints, messages get a buffer after a few
+    uint64_t frame_ = 0;
+    QElapsedTimer frameClock_;
+    bool animationUpdateQueued_ = false;
+
     bool messageWasAdded_ = false;
     bool lastMessageHasAlternateBackground_ = false;
     bool lastMessageHasAlternateBackgroundReverse_ = true;
@@ -1,11 +1,19 @@
 #include "DebugPopup.hpp"
 
+#include "debug/FrameStats.hpp"
+#include "messages/ImageLoader.hpp"
+#include "messages/ImageRegistry.hpp"
+#include "messages/ImageUploader.hpp"
+#include "util/Clipboard.hpp"
 #include "util/DebugCount.hpp"
 
 #include <QFontDatabase>
 #include <QHBoxLayout>
+#include <QJsonDocument>
 #include <QLabel>
+#include <QPushButton>
 #include <QTimer>
+#include <QVBoxLayout>
 
 namespace chatterino {
 
@@ -13,17 +21,35 @@ DebugPopup::DebugPopup()
 {
     auto *layout = new QHBoxLayout(this);
     auto *text = new QLabel(this);
+    auto *frameStats = new QLabel(this);
+    auto *copyFrameStats = new QPushButton("Copy frame stats as JSON", this);
     auto *timer = new QTimer(this);
 
     timer->setInterval(300);
-    QObject::connect(timer, &QTimer::timeout, [text] {
+    QObject::connect(timer, &QTimer::timeout, [text, frameStats] {
         text->setText(DebugCount::getDebugText());
+        frameStats->setText(FrameStats::getDebugText() + "\n" +
+                            ImageLoader::instance().getDebugText() +
+                            ImageUploader::instance().getDebugText() +
+                            ImageRegistry::instance().getDebugText());
     });
     timer->start();
 
+    QObject::connect(copyFrameStats, &QPushButton::clicked, [] {
+        crossPlatformCopy(QJsonDocument(FrameStats::toJson()).toJson());
+    });
+
     text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    text->setAlignment(Qt::AlignTop);
+    frameStats->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    frameStats->setAlignment(Qt::AlignTop);
+
+    auto *frameStatsLayout = new QVBoxLayout;
+    frameStatsLayout->addWidget(frameStats, 1);
+    frameStatsLayout->addWidget(copyFrameStats);
 
     layout->addWidget(text);
+    layout->addLayout(frameStatsLayout);
 }
 
 }  // namespace chatterino
@@ -0,0 +1,439 @@
+#include "widgets/helper/EmoteGridView.hpp"
+
+#include "Application.hpp"
+#include "messages/Emote.hpp"
+#include "singletons/Fonts.hpp"
+#include "singletons/Settings.hpp"
+#include "singletons/Theme.hpp"
+#include "singletons/TooltipPreviewImage.hpp"
+#include "singletons/WindowManager.hpp"
+#include "widgets/Scrollbar.hpp"
+#include "widgets/TooltipWidget.hpp"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <numeric>
+
+#define CELL_SIZE 36
+#define EMOTE_SIZE 28
+// rows above and below the visible ones whose images are loaded in advance
+#define PREFETCH_ROWS 2
+
+namespace chatterino {
+
+EmoteGridView::EmoteGridView(QWidget *parent)
+    : BaseWidget(parent)
+    , scrollBar_(new Scrollbar(this))
+{
+    this->setMouseTracking(true);
+
+    this->scrollBar_->getCurrentValueChanged().connect([this] {
+        this->update();
+    });
+
+    // images finished loading
+    this->signalHolder_.managedConnect(
+        getApp()->windows->layoutRequested, [this](Channel *) {
+            if (this->isVisible())
+            {
+                this->update();
+            }
+        });
+
+    this->signalHolder_.managedConnect(
+        getApp()->windows->gifRepaintRequested, [this] {
+            if (this->isVisible() && this->paintedAnimated_)
+            {
+                this->update();
+            }
+        });
+}
+
+void EmoteGridView::setSections(std::vector<Section> sections)
+{
+    this->sections_.clear();
+    this->sections_.reserve(sections.size());
+    this->hoveredItem_ = nullptr;
+
+    for (auto &section : sections)
+    {
+        IndexedSection indexed;
+        indexed.title = std::move(section.title);
+        indexed.emptyText = std::move(section.emptyText);
+        indexed.items = std::move(section.items);
+        indexed.keys.reserve(indexed.items.size());
+
+        for (const auto &item : indexed.items)
+        {
+            indexed.keys.push_back(item.emote->name.string.toLower());
+        }
+
+        this->sections_.push_back(std::move(indexed));
+    }
+
+    this->filter_.clear();
+    for (auto &section : this->sections_)
+    {
+        section.visible.resize(section.items.size());
+        std::iota(section.visible.begin(), section.visible.end(), 0);
+    }
+
+    this->scrollBar_->setDesiredValue(0);
+    this->layoutRows();
+}
+
+void EmoteGridView::setFilter(const QString &filter)
+{
+    auto lowered = filter.toLower();
+    if (lowered == this->filter_)
+    {
+        return;
+    }
+
+    // typing narrows the filter, so only the current matches can still match
+    auto narrowing = lowered.contains(this->filter_);
+    this->filter_ = lowered;
+    this->hoveredItem_ = nullptr;
+
+    for (auto &section : this->sections_)
+    {
+        if (!narrowing)
+        {
+            section.visible.resize(section.items.size());
+            std::iota(section.visible.begin(), section.visible.end(), 0);
+        }
+
+        if (!lowered.isEmpty())
+        {
+            section.visible.erase(
+                std::remove_if(section.visible.begin(), section.visible.end(),
+                               [&](int index) {
+                                   return !section.keys[size_t(index)]
+                                               .contains(lowered);
+                               }),
+                section.visible.end());
+        }
+    }
+
+    this->scrollBar_->setDesiredValue(0);
+    this->layoutRows();
+}
+
+Scrollbar &EmoteGridView::getScrollBar()
+{
+    return *this->scrollBar_;
+}
+
+int EmoteGridView::cellSize() const
+{
+    return int(CELL_SIZE * this->scale());
+}
+
+int EmoteGridView::titleHeight() const
+{
+    return getApp()
+               ->fonts->getFontMetrics(FontStyle::ChatMediumBold, this->scale())
+               .height() +
+           int(8 * this->scale());
+}
+
+int EmoteGridView::columns() const
+{
+    auto width = this->width() - this->scrollBar_->width();
+
+    return std::max(1, width / this->cellSize());
+}
+
+void EmoteGridView::layoutRows()
+{
+    this->rows_.clear();
+
+    auto columns = this->columns();
+    auto cellSize = this->cellSize();
+    auto titleHeight = this->titleHeight();
+    auto y = 0;
+
+    for (int i = 0; i < int(this->sections_.size()); i++)
+    {
+        const auto &section = this->sections_[size_t(i)];
+        auto count = int(section.visible.size());
+
+        if (count == 0 && !this->filter_.isEmpty())
+        {
+            continue;
+        }
+
+        if (!section.title.isEmpty())
+        {
+            this->rows_.push_back({Row::Title, i, 0, 0, y, titleHeight});
+            y += titleHeight;
+        }
+
+        if (count == 0)
+        {
+            if (!section.emptyText.isEmpty())
+            {
+                this->rows_.push_back({Row::Empty, i, 0, 0, y, titleHeight});
+                y += titleHeight;
+            }
+            continue;
+        }
+
+        for (int first = 0; first < count; first += columns)
+        {
+            this->rows_.push_back({Row::Emotes, i, first,
+                                   std::min(columns, count - first), y,
+                                   cellSize});
+            y += cellSize;
+        }
+    }
+
+    this->contentHeight_ = y;
+
+    this->scrollBar_->setMaximum(this->contentHeight_);
+    this->scrollBar_->setLargeChange(this->height());
+    this->scrollBar_->setSmallChange(cellSize);
+    this->scrollBar_->setVisible(this->contentHeight_ > this->height());
+
+    this->update();
+}
+
+int EmoteGridView::firstRowAt(int y) const
+{
+    auto it = std::upper_bound(this->rows_.begin(), this->rows_.end(), y,
+                               [](int value, const Row &row) {
+                                   return value < row.y + row.height;
+                               });
+
+    return int(it - this->rows_.begin());
+}
+
+const EmoteGridView::Item *EmoteGridView::itemAt(const QPoint &pos) const
+{
+    auto y = pos.y() + int(this->scrollBar_->getCurrentValue());
+    auto index = this->firstRowAt(y);
+
+    if (index >= int(this->rows_.size()))
+    {
+        return nullptr;
+    }
+
+    const auto &row = this->rows_[size_t(index)];
+    if (row.kind != Row::Emotes || y < row.y)
+    {
+        return nullptr;
+    }
+
+    auto cellSize = this->cellSize();
+    auto left = (this->width() - this->scrollBar_->width() -
+                 this->columns() * cellSize) /
+                2;
+    auto column = (pos.x() - left) / cellSize;
+
+    if (pos.x() < left || column >= row.count)
+    {
+        return nullptr;
+    }
+
+    const auto &section = this->sections_[size_t(row.section)];
+    return &section.items[size_t(section.visible[size_t(row.first + column)])];
+}
+
+void EmoteGridView::loadImages(const Row &row) const
+{
+    if (row.kind != Row::Emotes)
+    {
+        return;
+    }
+
+    const auto &section = this->sections_[size_t(row.section)];
+    for (int i = row.first; i < row.first + row.count; i++)
+    {
+        const auto &item = section.items[size_t(section.visible[size_t(i)])];
+        item.emote->images.getImage(this->scale())->load(
+            ImageLoadPriority::Near);
+    }
+}
+
+void EmoteGridView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.fillRect(this->rect(), this->theme->splits.background);
+
+    auto app = getApp();
+    auto scroll = int(this->scrollBar_->getCurrentValue());
+    auto cellSize = this->cellSize();
+    qreal emoteSize = EMOTE_SIZE * this->scale();
+    auto gridWidth = this->width() - this->scrollBar_->width();
+    auto left = (gridWidth - this->columns() * cellSize) / 2;
+
+    painter.setFont(
+        app->fonts->getFont(FontStyle::ChatMediumBold, this->scale()));
+
+    this->paintedAnimated_ = false;
+
+    auto first = this->firstRowAt(scroll);
+    auto last = first;
+
+    for (; last < int(this->rows_.size()); last++)
+    {
+        const auto &row = this->rows_[size_t(last)];
+        auto y = row.y - scroll;
+
+        if (y > this->height())
+        {
+            break;
+        }
+
+        const auto &section = this->sections_[size_t(row.section)];
+
+        if (row.kind == Row::Title || row.kind == Row::Empty)
+        {
+            painter.setPen(row.kind == Row::Title
+                               ? this->theme->messages.textColors.regular
+                               : this->theme->messages.textColors.system);
+            painter.drawText(QRect(0, y, gridWidth, row.height),
+                             Qt::AlignCenter,
+                             row.kind == Row::Title ? section.title
+                                                    : section.emptyText);
+            continue;
+        }
+
+        for (int i = 0; i < row.count; i++)
+        {
+            const auto &item =
+                section.items[size_t(section.visible[size_t(row.first + i)])];
+            QRect cell(left + i * cellSize, y, cellSize, cellSize);
+
+            if (&item == this->hoveredItem_)
+            {
+                painter.fillRect(cell, this->theme->messages.selection);
+            }
+
+            const auto &image = item.emote->images.getImage(this->scale());
+
+            // fit the emote into the cell, keeping its aspect ratio
+            QSizeF size(image->width() * this->scale(),
+                        image->height() * this->scale());
+            size.scale(std::min(size.width(), emoteSize),
+                       std::min(size.height(), emoteSize), Qt::KeepAspectRatio);
+
+            auto pixmap = image->scaledPixmapOrLoad(
+                (size * this->devicePixelRatioF()).toSize());
+            if (!pixmap)
+            {
+                continue;
+            }
+
+            this->paintedAnimated_ |= image->animated();
+
+            QRectF target(QPointF(), size);
+            target.moveCenter(QRectF(cell).center());
+            painter.drawPixmap(target, *pixmap, QRectF());
+        }
+    }
+
+    // load the images that are about to be scrolled into view
+    for (int i = std::max(0, first - PREFETCH_ROWS);
+         i < std::min(int(this->rows_.size()), last + PREFETCH_ROWS); i++)
+    {
+        this->loadImages(this->rows_[size_t(i)]);
+    }
+}
+
+void EmoteGridView::resizeEvent(QResizeEvent *)
+{
+    this->scrollBar_->setGeometry(this->width() - this->scrollBar_->width(), 0,
+                                  this->scrollBar_->width(), this->height());
+    this->scrollBar_->raise();
+
+    this->layoutRows();
+}
+
+void EmoteGridView::wheelEvent(QWheelEvent *event)
+{
+    if (!event->angleDelta().y() || !this->scrollBar_->isVisible())
+    {
+        return;
+    }
+
+    float mouseMultiplier = getSettings()->mouseScrollMultiplier;
+    this->scrollBar_->offset(-event->angleDelta().y() * qreal(0.5) *
+                             mouseMultiplier * this->scale());
+}
+
+void EmoteGridView::mouseMoveEvent(QMouseEvent *event)
+{
+    auto item = this->itemAt(event->pos());
+    auto tooltipWidget = TooltipWidget::instance();
+
+    if (item != this->hoveredItem_)
+    {
+        this->hoveredItem_ = item;
+        this->update();
+    }
+
+    if (item == nullptr)
+    {
+        this->setCursor(Qt::ArrowCursor);
+        tooltipWidget->hide();
+        return;
+    }
+
+    this->setCursor(Qt::PointingHandCursor);
+
+    // same preview as for emotes in chat
+    auto &tooltipPreviewImage = TooltipPreviewImage::instance();
+    tooltipPreviewImage.setImageScale(0, 0);
+
+    auto preview = getSettings()->emotesTooltipPreview.getValue();
+    if (preview == 1 ||
+        (preview != 0 && event->modifiers() == Qt::ShiftModifier))
+    {
+        tooltipPreviewImage.setImage(item->emote->images.getImage(3.0));
+    }
+    else
+    {
+        tooltipPreviewImage.setImage(nullptr);
+    }
+
+    tooltipWidget->moveTo(this, event->globalPos());
+    tooltipWidget->setWordWrap(false);
+    tooltipWidget->setText(item->emote->tooltip.string);
+    tooltipWidget->adjustSize();
+    tooltipWidget->setWindowFlag(Qt::WindowStaysOnTopHint, true);
+    tooltipWidget->show();
+    tooltipWidget->raise();
+}
+
+void EmoteGridView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+    {
+        return;
+    }
+
+    if (auto item = this->itemAt(event->pos()))
+    {
+        this->linkClicked.invoke(item->link);
+    }
+}
+
+void EmoteGridView::leaveEvent(QEvent *)
+{
+    TooltipWidget::instance()->hide();
+
+    this->hoveredItem_ = nullptr;
+    this->update();
+}
+
+void EmoteGridView::scaleChangedEvent(float)
+{
+    this->layoutRows();
+}
+
+}  // namespace chatterino
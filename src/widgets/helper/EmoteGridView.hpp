@@ -0,0 +1,107 @@
+#pragma once
+
+#include "messages/Link.hpp"
+#include "widgets/BaseWidget.hpp"
+
+#include <pajlada/signals/signal.hpp>
+#include <pajlada/signals/signalholder.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace chatterino {
+
+struct Emote;
+using EmotePtr = std::shared_ptr<const Emote>;
+class Scrollbar;
+
+/// Shows emotes in a grid of equally sized cells, grouped into titled
+/// sections.
+///
+/// Only the rows in view are painted and only their images (and the images
+/// of a few rows around them) are loaded, so the number of emotes doesn't
+/// matter for opening or scrolling the view. Filtering only looks at the
+/// lowercased emote names that are indexed in setSections.
+class EmoteGridView : public BaseWidget
+{
+    Q_OBJECT
+
+public:
+    struct Item {
+        EmotePtr emote;
+        Link link;
+    };
+
+    struct Section {
+        // no title row is shown if it's empty
+        QString title;
+        std::vector<Item> items;
+        // shown instead of the emotes if there are none, nothing is shown if
+        // it's empty
+        QString emptyText = "no emotes available";
+    };
+
+    explicit EmoteGridView(QWidget *parent = nullptr);
+
+    void setSections(std::vector<Section> sections);
+
+    // Only shows emotes containing `filter`, case insensitive. Sections
+    // without matches are hidden while filtering.
+    void setFilter(const QString &filter);
+
+    Scrollbar &getScrollBar();
+
+    pajlada::Signals::Signal<Link> linkClicked;
+
+protected:
+    void paintEvent(QPaintEvent *) override;
+    void resizeEvent(QResizeEvent *) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *) override;
+    void scaleChangedEvent(float newScale) override;
+
+private:
+    struct IndexedSection {
+        QString title;
+        QString emptyText;
+        std::vector<Item> items;
+        // lowercased emote names, same order as items
+        std::vector<QString> keys;
+        // indices of the items matching the current filter
+        std::vector<int> visible;
+    };
+
+    struct Row {
+        enum Kind { Title, Emotes, Empty } kind;
+        int section;
+        // first index into IndexedSection::visible, for emote rows
+        int first;
+        int count;
+        int y;
+        int height;
+    };
+
+    void layoutRows();
+    int firstRowAt(int y) const;
+    const Item *itemAt(const QPoint &pos) const;
+    void loadImages(const Row &row) const;
+
+    int cellSize() const;
+    int titleHeight() const;
+    int columns() const;
+
+    std::vector<IndexedSection> sections_;
+    std::vector<Row> rows_;
+    int contentHeight_ = 0;
+
+    QString filter_;
+    const Item *hoveredItem_ = nullptr;
+    bool paintedAnimated_ = false;
+
+    Scrollbar *scrollBar_;
+    pajlada::Signals::SignalHolder signalHolder_;
+};
+
+}  // namespace chatterino
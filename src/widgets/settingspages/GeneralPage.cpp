@@ -510,6 +510,11 @@ void GeneralPage::initLayout(GeneralPageView &layout)
         layout.addLayout(box);
     }
 
+    layout.addIntInput("Maximum cache size (MB)", s.diskCacheMaxSize, 64,
+                       65536, 64);
+    layout.addIntInput("Keep cached files for (days)", s.diskCacheMaxAge, 1,
+                       365, 1);
+
     layout.addTitle("Advanced");
 
     layout.addSubtitle("Chat title");
@@ -585,6 +590,14 @@ void GeneralPage::initLayout(GeneralPageView &layout)
     }
 
     layout.addCheckbox("Restart on crash", s.restartOnCrash);
+    layout.addCheckbox(
+        "Only buffer messages that stay on screen (saves memory while "
+        "scrolling)",
+        s.lazyMessageBuffers);
+    layout.addIntInput("Memory for loaded emotes and badges (MB)",
+                       s.imageMemoryBudget, 64, 4096, 64);
+    layout.addIntInput("Emotes and badges loaded at once",
+                       s.imageLoadConcurrency, 1, 64, 1);
 
 #ifdef Q_OS_LINUX
     if (!getPaths()->isPortable())
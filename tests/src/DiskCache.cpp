@@ -0,0 +1,204 @@
+#include "common/DiskCache.hpp"
+
+#include <gtest/gtest.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+using namespace chatterino;
+
+namespace {
+
+QByteArray testData(char fill, int size = 1024)
+{
+    return QByteArray(size, fill);
+}
+
+QByteArray testKey(int index)
+{
+    return QByteArray("key-") + QByteArray::number(index);
+}
+
+}  // namespace
+
+TEST(DiskCache, GetAndPut)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    DiskCache cache;
+    cache.setDirectory(dir.path());
+
+    EXPECT_FALSE(cache.get(testKey(0)));
+
+    cache.put(testKey(0), testData('a'), 203, "\"etag\"");
+
+    auto entry = cache.get(testKey(0));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->data, testData('a'));
+    EXPECT_EQ(entry->status, 203);
+    EXPECT_EQ(entry->etag, QByteArray("\"etag\""));
+    EXPECT_TRUE(entry->storedAt.isValid());
+
+    // replacing the data
+    cache.put(testKey(0), testData('b'), 200);
+    entry = cache.get(testKey(0));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->data, testData('b'));
+    EXPECT_TRUE(entry->etag.isEmpty());
+
+    cache.remove(testKey(0));
+    EXPECT_FALSE(cache.get(testKey(0)));
+
+    // empty bodies aren't kept
+    cache.put(testKey(1), QByteArray(), 200);
+    EXPECT_FALSE(cache.get(testKey(1)));
+}
+
+TEST(DiskCache, IdenticalDataIsStoredOnce)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    DiskCache cache;
+    cache.setDirectory(dir.path());
+
+    auto data = testData('a', 100 * 1024);
+    cache.put(testKey(0), data, 200);
+    cache.put(testKey(1), data, 200);
+
+    EXPECT_EQ(QFileInfo(dir.filePath("segment-0")).size(), data.size());
+
+    // the other key still uses the data
+    cache.remove(testKey(0));
+    cache.maintain();
+
+    auto entry = cache.get(testKey(1));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->data, data);
+}
+
+TEST(DiskCache, Evict)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    DiskCache cache;
+    cache.setLimits(4 * 1024, std::chrono::hours(24));
+    cache.setDirectory(dir.path());
+
+    for (int i = 0; i < 8; i++)
+    {
+        cache.put(testKey(i), testData(char('a' + i)), 200);
+    }
+    cache.maintain();
+
+    auto remaining = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        if (auto entry = cache.get(testKey(i)))
+        {
+            EXPECT_EQ(entry->data, testData(char('a' + i)));
+            remaining++;
+        }
+    }
+
+    // evicts down to 90% of the limit
+    EXPECT_GE(remaining, 3);
+    EXPECT_LE(remaining, 4);
+}
+
+TEST(DiskCache, Expire)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    DiskCache cache;
+    cache.setDirectory(dir.path());
+
+    cache.put(testKey(0), testData('a'), 200);
+    cache.put(testKey(1), testData('b'), 200);
+    ASSERT_TRUE(cache.get(testKey(0)));
+
+    // everything is older than that
+    cache.setLimits(1024 * 1024, std::chrono::seconds(-1));
+    EXPECT_FALSE(cache.get(testKey(0)));
+
+    cache.maintain();
+    cache.setLimits(1024 * 1024, std::chrono::hours(24));
+
+    // removed by the maintenance, not only hidden by the age limit
+    EXPECT_FALSE(cache.get(testKey(1)));
+}
+
+TEST(DiskCache, Compact)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    DiskCache cache;
+    cache.setLimits(1024 * 1024, std::chrono::hours(24), 4 * 1024);
+    cache.setDirectory(dir.path());
+
+    // four records per segment
+    for (int i = 0; i < 8; i++)
+    {
+        cache.put(testKey(i), testData(char('a' + i)), 200);
+    }
+    ASSERT_TRUE(QFile::exists(dir.filePath("segment-0")));
+    ASSERT_TRUE(QFile::exists(dir.filePath("segment-1")));
+
+    // only the last record of the first segment is used
+    for (int i = 0; i < 3; i++)
+    {
+        cache.remove(testKey(i));
+    }
+    cache.maintain();
+
+    EXPECT_FALSE(QFile::exists(dir.filePath("segment-0")));
+
+    for (int i = 3; i < 8; i++)
+    {
+        auto entry = cache.get(testKey(i));
+        ASSERT_TRUE(entry);
+        EXPECT_EQ(entry->data, testData(char('a' + i)));
+    }
+}
+
+TEST(DiskCache, Reopen)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    {
+        DiskCache cache;
+        cache.setDirectory(dir.path());
+
+        cache.put(testKey(0), testData('a'), 200, "\"etag\"");
+        cache.put(testKey(1), testData('b'), 404);
+    }
+
+    DiskCache cache;
+    cache.setDirectory(dir.path());
+
+    auto entry = cache.get(testKey(0));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->data, testData('a'));
+    EXPECT_EQ(entry->etag, QByteArray("\"etag\""));
+
+    entry = cache.get(testKey(1));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->data, testData('b'));
+    EXPECT_EQ(entry->status, 404);
+
+    // a corrupt index discards the cache
+    cache.setDirectory(QString());
+    {
+        QFile index(dir.filePath("index"));
+        ASSERT_TRUE(index.open(QIODevice::WriteOnly));
+        index.write("garbage");
+    }
+    cache.setDirectory(dir.path());
+
+    EXPECT_FALSE(cache.get(testKey(0)));
+}
@@ -0,0 +1,107 @@
+#include "messages/ImageRegistry.hpp"
+
+#include "messages/Image.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace chatterino;
+
+namespace {
+
+Url testUrl(const QString &test, int index)
+{
+    return Url{QString("https://example.com/%1/%2.png").arg(test).arg(index)};
+}
+
+}  // namespace
+
+TEST(ImageRegistry, SameUrlReturnsSameImage)
+{
+    auto &registry = ImageRegistry::instance();
+    auto live = registry.liveCount();
+
+    auto a = Image::fromUrl(testUrl("same", 0));
+    auto b = Image::fromUrl(testUrl("same", 0));
+    auto c = Image::fromUrl(testUrl("same", 1));
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(registry.liveCount(), live + 2);
+}
+
+TEST(ImageRegistry, DestroyedImageLeavesTombstone)
+{
+    auto &registry = ImageRegistry::instance();
+    auto live = registry.liveCount();
+    auto tombstones = registry.tombstoneCount();
+
+    auto image = Image::fromUrl(testUrl("tombstone", 0));
+    EXPECT_EQ(registry.liveCount(), live + 1);
+
+    image.reset();
+    EXPECT_EQ(registry.liveCount(), live);
+    EXPECT_EQ(registry.tombstoneCount(), tombstones + 1);
+}
+
+TEST(ImageRegistry, TombstoneIsReused)
+{
+    auto &registry = ImageRegistry::instance();
+    auto live = registry.liveCount();
+    auto tombstones = registry.tombstoneCount();
+
+    Image::fromUrl(testUrl("reuse", 0));
+    EXPECT_EQ(registry.tombstoneCount(), tombstones + 1);
+
+    auto image = Image::fromUrl(testUrl("reuse", 0));
+    EXPECT_EQ(registry.liveCount(), live + 1);
+    EXPECT_EQ(registry.tombstoneCount(), tombstones);
+}
+
+TEST(ImageRegistry, TombstonesAreSwept)
+{
+    auto &registry = ImageRegistry::instance();
+    auto live = registry.liveCount();
+    auto tombstones = registry.tombstoneCount();
+
+    constexpr int count = 20000;
+    for (int i = 0; i < count; i++)
+    {
+        Image::fromUrl(testUrl("sweep", i));
+    }
+
+    EXPECT_EQ(registry.liveCount(), live);
+    EXPECT_GE(registry.tombstoneCount(), 0);
+    // every shard is swept at least every 256 inserts
+    EXPECT_LT(registry.tombstoneCount() - tombstones, count / 2);
+}
+
+TEST(ImageRegistry, CountsStayConsistentAcrossThreads)
+{
+    auto &registry = ImageRegistry::instance();
+    auto live = registry.liveCount();
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; thread++)
+    {
+        threads.emplace_back([&registry] {
+            for (int i = 0; i < 5000; i++)
+            {
+                // the threads keep creating and destroying the same images
+                auto image = Image::fromUrl(testUrl("threads", i % 64));
+                EXPECT_GE(registry.liveCount(), 0);
+                EXPECT_GE(registry.tombstoneCount(), 0);
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(registry.liveCount(), live);
+    EXPECT_GE(registry.tombstoneCount(), 0);
+}